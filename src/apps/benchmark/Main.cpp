@@ -69,6 +69,6 @@ int main()
     std::cout << "Elapsed time: " << cell::stringutils::timeString(ns) << "\n";
     std::cout << "Time per update: " << cell::stringutils::timeString(ns / N) << "\n";
 
-    for (const auto& [typeID, count] : CollisionDetector::getAndResetCollisionCounts())
+    for (const auto& [typeID, count] : cell.getAndResetCollisionCounts())
         std::cout << registry.getByID(typeID).getName() << ": " << count << " collisions" << "\n";
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
+#include "cell/DataPointSink.hpp"
+#include "cell/EquilibriumDetector.hpp"
+#include "cell/ResultCache.hpp"
 #include "cell/SimulationContext.hpp"
-#include "cell/SimulationRecordSerializer.hpp"
 #include "cell/SimulationRecorder.hpp"
 #include "cell/SimulationRunner.hpp"
 #include "cell/StringUtils.hpp"
@@ -7,11 +9,81 @@
 #include <CLI/CLI.hpp>
 
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace fs = std::filesystem;
 using namespace std::chrono_literals;
 
+namespace
+{
+
+ch::nanoseconds toNanoseconds(double seconds)
+{
+    // Rounded, so that e. g. 0.3s is a multiple of 0.1s
+    return ch::round<ch::nanoseconds>(ch::duration<double>{seconds});
+}
+
+cell::SimulationConfig readConfigFile(const fs::path& configFile)
+{
+    nlohmann::json j;
+    std::ifstream file(configFile);
+    file >> j;
+
+    return j["config"].get<cell::SimulationConfig>();
+}
+
+/**
+ * @brief out.csv becomes out_replica3.csv
+ */
+fs::path getReplicaOutFile(fs::path outFile, int replica)
+{
+    const auto extension = outFile.extension();
+    outFile.replace_filename(outFile.stem().string() + "_replica" + std::to_string(replica));
+
+    return outFile.replace_extension(extension);
+}
+
+/**
+ * @brief Creates a recorder that streams the type counts of the simulation of the runner into the given file. With
+ * `continuedTime`, the rows are appended to the file of an earlier run that the simulation continues from, and the
+ * initial state isn't recorded again
+ */
+std::unique_ptr<cell::SimulationRecorder> createRecorder(cell::SimulationRunner& simulationRunner,
+                                                         const fs::path& outFile, double storageInterval,
+                                                         std::optional<ch::nanoseconds> continuedTime = std::nullopt)
+{
+    const auto& discTypeRegistry = simulationRunner.getSimulationContext().discTypeRegistry;
+    auto simulationRecorder = std::make_unique<cell::SimulationRecorder>(
+        discTypeRegistry, simulationRunner.getSimulationConfig().mostProbableSpeed);
+    simulationRecorder->setStorageInterval(toNanoseconds(storageInterval));
+
+    // Data points are written as they arrive, so memory usage doesn't grow with the simulation duration
+    auto* recorder = simulationRecorder.get();
+    if (continuedTime)
+    {
+        recorder->setDataPointSink(
+            std::make_unique<cell::TypeCountsCsvSink>(outFile, discTypeRegistry, *continuedTime));
+    }
+    else
+    {
+        recorder->setDataPointSink(std::make_unique<cell::TypeCountsCsvSink>(outFile, discTypeRegistry));
+        simulationRunner.setPostBuildCallback([=](cell::Cell& cell) { recorder->processInitialSimulationData(cell); });
+    }
+
+    simulationRunner.setPostUpdateCallback([=](cell::Cell& cell, const ch::nanoseconds& elapsedTime)
+                                           { recorder->processSimulationData(cell, elapsedTime); });
+
+    return simulationRecorder;
+}
+
+} // namespace
+
 int main(int argc, char** argv)
 {
     CLI::App app{"Cell 1.1.1\nCommand line interface for the cell simulation\nBuild time: " + std::string{__DATE__} +
@@ -21,6 +93,14 @@ int main(int argc, char** argv)
     fs::path outFile;
     double duration{};
     double storageInterval{};
+    std::string equilibriumAction = "none";
+    cell::EquilibriumDetector::Params equilibriumParams;
+    double equilibriumStorageInterval{};
+    int replicas = 0;
+    double equilibrationTime{};
+    std::vector<fs::path> replicaConfigFiles;
+    std::uint64_t seed{};
+    fs::path cacheDirectory;
 
     CLI::Validator positiveDouble{[](const std::string& value) -> std::string
                                   {
@@ -47,22 +127,117 @@ int main(int argc, char** argv)
     app.add_option("--storage-interval", storageInterval, "Storage interval in seconds")
         ->required()
         ->check(positiveDouble);
+    app.add_option("--equilibrium", equilibriumAction,
+                   "What to do once type counts and kinetic energy stop drifting: keep running (none), stop the "
+                   "simulation (stop) or continue with a longer storage interval (coarsen)")
+        ->check(CLI::IsMember({"none", "stop", "coarsen"}));
+    app.add_option("--equilibrium-window", equilibriumParams.windowSize,
+                   "Number of data points in each of the 2 compared windows")
+        ->check(CLI::Range(2, std::numeric_limits<int>::max()));
+    app.add_option("--equilibrium-tolerance", equilibriumParams.relativeTolerance,
+                   "Relative change of the window means that still counts as equilibrium")
+        ->check(positiveDouble);
+    app.add_option("--equilibrium-storage-interval", equilibriumStorageInterval,
+                   "Storage interval in seconds after the equilibrium was reached with --equilibrium coarsen, 10 "
+                   "times the storage interval by default")
+        ->check(positiveDouble);
+    app.add_option("--replicas", replicas,
+                   "Number of replicas that continue from the final state of the run in parallel, each for "
+                   "--duration seconds and with its own output file (out_replica<i>.csv)")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--equilibration", equilibrationTime,
+                   "Simulation time in seconds of the run that the replicas continue from, --duration by default")
+        ->check(positiveDouble);
+    app.add_option("--replica-config", replicaConfigFiles,
+                   "Config files that the replicas use in turn, e. g. with other reactions. They must have the same "
+                   "types and membranes as --config, which is used by default")
+        ->check(CLI::ExistingFile);
+    app.add_option("--seed", seed,
+                   "Seed of the random number generators of the simulation, replica i uses seed + i + 1. Random by "
+                   "default");
+    app.add_option("--cache", cacheDirectory,
+                   "Directory with the results of earlier runs. A run with the same config, seed and storage interval "
+                   "is copied from there instead of simulated again, a longer one continues from its final state");
 
     CLI11_PARSE(app, argc, argv);
 
+    const bool useSeed = app.count("--seed") > 0;
+
+    // Replicas and runs that stop early don't have a single final state that a longer run could continue from
+    std::optional<cell::ResultCache> resultCache;
+    std::optional<cell::ResultCache::Key> cacheKey;
+    std::optional<cell::ResultCache::Entry> cacheEntry;
+    if (!cacheDirectory.empty() && (replicas > 0 || equilibriumAction != "none"))
+        std::cout << "Not using the result cache, it doesn't support replicas and equilibrium detection\n";
+    else if (!cacheDirectory.empty() && toNanoseconds(duration) % toNanoseconds(storageInterval) != ch::nanoseconds{0})
+        std::cout << "Not using the result cache, the duration isn't a multiple of the storage interval\n";
+    else if (!cacheDirectory.empty())
+    {
+        resultCache.emplace(cacheDirectory);
+        cacheKey = cell::ResultCache::Key{.simulationConfig = readConfigFile(configFile),
+                                          .seed = useSeed ? std::optional{seed} : std::nullopt,
+                                          .storageInterval = toNanoseconds(storageInterval)};
+        cacheEntry = resultCache->find(*cacheKey);
+
+        if (cacheEntry && cacheEntry->duration >= toNanoseconds(duration))
+        {
+            resultCache->writeTypeCounts(*cacheKey, *cacheEntry, outFile, toNanoseconds(duration));
+            std::cout << "Copied result from cache entry " << cell::ResultCache::hash(*cacheKey) << "\n";
+
+            return 0;
+        }
+    }
+
     cell::SimulationRunner simulationRunner;
-    simulationRunner.useConfigFile(configFile);
-    simulationRunner.setSimulationDuration(ch::duration_cast<ch::nanoseconds>(ch::duration<double>{duration}));
+    std::optional<ch::nanoseconds> continuedTime;
+    if (cacheEntry)
+    {
+        // The random number generators aren't part of the checkpoint, so the continued run is statistically, but not
+        // bitwise, the same as a run from the start
+        std::cout << "Continuing cache entry " << cell::ResultCache::hash(*cacheKey) << " after "
+                  << cell::stringutils::timeString(cacheEntry->duration.count()) << "\n";
+        resultCache->writeTypeCounts(*cacheKey, *cacheEntry, outFile, cacheEntry->duration);
+        continuedTime = cacheEntry->duration;
+        simulationRunner.useConfig(cacheEntry->checkpoint);
+        simulationRunner.setSimulationDuration(toNanoseconds(duration) - cacheEntry->duration);
+    }
+    else
+    {
+        simulationRunner.useConfigFile(configFile);
+        simulationRunner.setSimulationDuration(
+            toNanoseconds(replicas > 0 && equilibrationTime > 0 ? equilibrationTime : duration));
+    }
+    if (useSeed)
+        simulationRunner.setRandomSeed(seed);
 
-    cell::SimulationRecorder simulationRecorder(simulationRunner.getSimulationContext().discTypeRegistry,
-                                                simulationRunner.getSimulationConfig().mostProbableSpeed);
-    simulationRecorder.setStorageInterval(ch::duration_cast<ch::nanoseconds>(ch::duration<double>(storageInterval)));
+    auto simulationRecorder = createRecorder(simulationRunner, outFile, storageInterval, continuedTime);
     simulationRunner.setPerformanceDataCallback([&](auto data)
-                                                { simulationRecorder.printPerformanceData(std::move(data)); });
-    simulationRunner.setPostBuildCallback([&](cell::Cell& cell)
-                                          { simulationRecorder.processInitialSimulationData(cell); });
-    simulationRunner.setPostUpdateCallback([&](cell::Cell& cell, const ch::nanoseconds& elapsedTime)
-                                           { simulationRecorder.processSimulationData(cell, elapsedTime); });
+                                                { simulationRecorder->printPerformanceData(std::move(data)); });
+
+    // Data points arrive on the simulation thread, so the recorder and the runner can be changed from the callback
+    std::optional<cell::EquilibriumDetector> equilibriumDetector;
+    if (equilibriumAction != "none")
+    {
+        equilibriumDetector.emplace(simulationRunner.getSimulationContext().discTypeRegistry.getIDs(),
+                                    equilibriumParams);
+        if (equilibriumStorageInterval <= 0)
+            equilibriumStorageInterval = 10 * storageInterval;
+
+        simulationRecorder->setNewDataPointCallback(
+            [&](const cell::DataPoint& dataPoint)
+            {
+                if (!equilibriumDetector->add(dataPoint.getData()))
+                    return;
+
+                std::cout << "Reached equilibrium after "
+                          << cell::stringutils::timeString(equilibriumDetector->getEquilibriumTime().count()) << "\n";
+
+                if (equilibriumAction == "stop")
+                    simulationRunner.stopSimulation();
+                else
+                    simulationRecorder->setStorageInterval(toNanoseconds(equilibriumStorageInterval));
+            });
+    }
 
     std::cout << "Starting simulation\n";
     const auto start = ch::steady_clock::now();
@@ -71,11 +246,47 @@ int main(int argc, char** argv)
     const auto elapsed = ch::steady_clock::now() - start;
     std::cout << "Finished simulation in " << cell::stringutils::timeString(elapsed.count()) << "\n";
 
-    simulationRecorder.storeRemainingData();
+    simulationRecorder->storeRemainingData();
+
+    if (resultCache)
+    {
+        resultCache->store(*cacheKey, outFile, toNanoseconds(duration), simulationRunner.createCheckpoint());
+        std::cout << "Stored result in cache entry " << cell::ResultCache::hash(*cacheKey) << "\n";
+    }
+
+    if (replicas == 0)
+        return 0;
+
+    // The replicas share the type registries of the simulated cell and only copy its compartments and discs
+    std::vector<std::unique_ptr<cell::SimulationRunner>> replicaRunners;
+    std::vector<std::unique_ptr<cell::SimulationRecorder>> replicaRecorders;
+    for (int i = 0; i < replicas; ++i)
+    {
+        const auto replicaConfig = replicaConfigFiles.empty()
+                                       ? simulationRunner.getSimulationConfig()
+                                       : readConfigFile(replicaConfigFiles[static_cast<std::size_t>(i) %
+                                                                           replicaConfigFiles.size()]);
+
+        auto& replicaRunner = *replicaRunners.emplace_back(std::make_unique<cell::SimulationRunner>());
+        replicaRunner.useReplicaOf(simulationRunner, replicaConfig);
+        replicaRunner.setSimulationDuration(toNanoseconds(duration));
+        if (useSeed)
+            replicaRunner.setRandomSeed(seed + static_cast<std::uint64_t>(i) + 1);
+
+        replicaRecorders.push_back(createRecorder(replicaRunner, getReplicaOutFile(outFile, i), storageInterval));
+    }
+
+    std::cout << "Starting " << replicas << " replicas\n";
+    const auto replicasStart = ch::steady_clock::now();
+    for (auto& replicaRunner : replicaRunners)
+        replicaRunner->runSimulation();
+    for (auto& replicaRunner : replicaRunners)
+        replicaRunner->waitForSimulationToFinish();
+    const auto replicasElapsed = ch::steady_clock::now() - replicasStart;
+    std::cout << "Finished replicas in " << cell::stringutils::timeString(replicasElapsed.count()) << "\n";
 
-    cell::SimulationRecordSerializer simulationRecordSerializer;
-    simulationRecordSerializer.writeTypeCountsToCsv(simulationRecorder.getDataPoints(),
-                                                    simulationRunner.getSimulationContext().discTypeRegistry, outFile);
+    for (auto& replicaRecorder : replicaRecorders)
+        replicaRecorder->storeRemainingData();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "ConfigCache.hpp"
+#include "cell/ExceptionWithLocation.hpp"
+
+namespace cell
+{
+
+ConfigCache::ConfigCache(std::size_t capacity)
+    : capacity_(capacity)
+{
+    if (capacity_ == 0)
+        throw ExceptionWithLocation("Config cache capacity must be positive");
+}
+
+ConfigCache::BuiltConfig ConfigCache::get(const SimulationConfig& simulationConfig, bool& wasCached)
+{
+    // Dumped json objects have sorted keys, so equal configs have equal keys
+    const auto key = nlohmann::json(simulationConfig).dump();
+    std::promise<BuiltConfig> promise;
+    std::shared_future<BuiltConfig> builtConfig;
+    std::uint64_t entryID = 0;
+
+    {
+        std::scoped_lock lock(mutex_);
+        auto it = entries_.find(key);
+        wasCached = it != entries_.end();
+        if (wasCached)
+        {
+            usage_.splice(usage_.begin(), usage_, it->second.usage);
+            builtConfig = it->second.builtConfig;
+        }
+        else
+        {
+            if (entries_.size() == capacity_)
+            {
+                entries_.erase(usage_.back());
+                usage_.pop_back();
+            }
+
+            builtConfig = promise.get_future().share();
+            entryID = nextEntryID_++;
+            usage_.push_front(key);
+            entries_.emplace(key, Entry{.builtConfig = builtConfig, .usage = usage_.begin(), .ID = entryID});
+        }
+    }
+
+    if (wasCached)
+        return builtConfig.get();
+
+    try
+    {
+        auto simulationRunner = std::make_shared<SimulationRunner>();
+        simulationRunner->useConfig(simulationConfig);
+        promise.set_value(std::move(simulationRunner));
+    }
+    catch (...)
+    {
+        // Threads waiting for the same config get the exception as well, later jobs try again
+        promise.set_exception(std::current_exception());
+
+        std::scoped_lock lock(mutex_);
+        if (auto it = entries_.find(key); it != entries_.end() && it->second.ID == entryID)
+        {
+            usage_.erase(it->second.usage);
+            entries_.erase(it);
+        }
+    }
+
+    return builtConfig.get();
+}
+
+} // namespace cell
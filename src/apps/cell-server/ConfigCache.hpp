@@ -0,0 +1,61 @@
+#ifndef D44389FC_C8D5_49FF_A199_BC22FBED0D35_HPP
+#define D44389FC_C8D5_49FF_A199_BC22FBED0D35_HPP
+
+#include "cell/SimulationConfig.hpp"
+#include "cell/SimulationRunner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cell
+{
+
+/**
+ * @brief Keeps the built and populated cells of the last `capacity` configs. Jobs don't run these cells, they
+ * continue from a copy with SimulationRunner::useReplicaOf(), so building and populating happens once per config.
+ * Jobs with the same config therefore start from the same initial disc positions
+ */
+class ConfigCache
+{
+public:
+    using BuiltConfig = std::shared_ptr<const SimulationRunner>;
+
+public:
+    explicit ConfigCache(std::size_t capacity);
+
+    /**
+     * @brief Builds the config on first use, while other threads can use other configs. Thread-safe
+     * @param wasCached Set to whether the config was built already (or was being built by another thread)
+     * @returns A runner with the built cell that must not be run
+     */
+    BuiltConfig get(const SimulationConfig& simulationConfig, bool& wasCached);
+
+private:
+    struct Entry
+    {
+        std::shared_future<BuiltConfig> builtConfig;
+        std::list<std::string>::iterator usage;
+
+        // Tells entries for the same key apart, one might have been evicted and replaced while it was being built
+        std::uint64_t ID = 0;
+    };
+
+private:
+    std::size_t capacity_;
+    std::mutex mutex_;
+    std::uint64_t nextEntryID_ = 0;
+
+    // Keys are the dumped configs, most recently used first
+    std::list<std::string> usage_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace cell
+
+#endif /* D44389FC_C8D5_49FF_A199_BC22FBED0D35_HPP */
@@ -0,0 +1,108 @@
+#include "Connection.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+
+namespace cell
+{
+
+Connection::Connection(int socket)
+    : socket_(socket)
+{
+}
+
+Connection::~Connection()
+{
+    ::close(socket_);
+}
+
+bool Connection::readLine(std::string& line)
+{
+    std::array<char, 4096> chunk;
+    auto newline = buffer_.find('\n');
+    while (newline == std::string::npos)
+    {
+        const auto received = ::recv(socket_, chunk.data(), chunk.size(), 0);
+        if (received < 0 && errno == EINTR && !closed_)
+            continue;
+
+        // End of file only means that the client won't send more jobs, it might still wait for replies
+        if (received == 0 || closed_)
+            return false;
+
+        if (received < 0)
+        {
+            close();
+            return false;
+        }
+
+        // Only the new part can contain the line end
+        newline = buffer_.size();
+        buffer_.append(chunk.data(), static_cast<std::size_t>(received));
+        newline = buffer_.find('\n', newline);
+    }
+
+    line = buffer_.substr(0, newline);
+    buffer_.erase(0, newline + 1);
+
+    return true;
+}
+
+void Connection::beginJob()
+{
+    std::scoped_lock lock(jobMutex_);
+    ++runningJobs_;
+}
+
+void Connection::endJob()
+{
+    std::scoped_lock lock(jobMutex_);
+    if (--runningJobs_ == 0 && inputEnded_)
+        close();
+}
+
+void Connection::endInput()
+{
+    std::scoped_lock lock(jobMutex_);
+    inputEnded_ = true;
+    if (runningJobs_ == 0)
+        close();
+}
+
+void Connection::send(const nlohmann::json& message)
+{
+    const auto line = message.dump() + "\n";
+
+    std::scoped_lock lock(sendMutex_);
+    if (closed_)
+        return;
+
+    for (std::size_t sent = 0; sent < line.size();)
+    {
+        // MSG_NOSIGNAL: A client that went away must not kill the server with SIGPIPE
+        const auto result = ::send(socket_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (result < 0)
+        {
+            close();
+            return;
+        }
+
+        sent += static_cast<std::size_t>(result);
+    }
+}
+
+void Connection::close()
+{
+    closed_ = true;
+    ::shutdown(socket_, SHUT_RDWR);
+}
+
+bool Connection::isClosed() const
+{
+    return closed_;
+}
+
+} // namespace cell
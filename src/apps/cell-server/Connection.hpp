@@ -0,0 +1,68 @@
+#ifndef D4FCBCE1_B171_4A68_80D6_240CA4DD9EC5_HPP
+#define D4FCBCE1_B171_4A68_80D6_240CA4DD9EC5_HPP
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace cell
+{
+
+/**
+ * @brief Accepted client socket that exchanges newline-delimited json messages. Lines are read by a single thread,
+ * messages can be sent from any thread. A client that shuts down its sending side still gets the replies to the jobs
+ * it sent, the connection is closed once the last of them ended
+ */
+class Connection
+{
+public:
+    explicit Connection(int socket);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /**
+     * @returns false once the client stopped sending or close() was called
+     */
+    bool readLine(std::string& line);
+
+    /**
+     * @brief Keeps the connection open after the client stopped sending, until endJob() was called as often
+     */
+    void beginJob();
+    void endJob();
+
+    /**
+     * @brief Called once readLine() returned false, closes the connection if no job is running anymore
+     */
+    void endInput();
+
+    /**
+     * @brief Writes the message as a single line. Failing to write closes the connection, since the client then
+     * can't follow the protocol anymore
+     */
+    void send(const nlohmann::json& message);
+
+    /**
+     * @brief Shuts the socket down, which also lets a blocked readLine() return. Thread-safe
+     */
+    void close();
+    bool isClosed() const;
+
+private:
+    int socket_;
+    std::string buffer_;
+    std::mutex sendMutex_;
+    std::atomic<bool> closed_ = false;
+
+    std::mutex jobMutex_;
+    std::size_t runningJobs_ = 0;
+    bool inputEnded_ = false;
+};
+
+} // namespace cell
+
+#endif /* D4FCBCE1_B171_4A68_80D6_240CA4DD9EC5_HPP */
@@ -0,0 +1,60 @@
+#include "JobPool.hpp"
+#include "cell/ExceptionWithLocation.hpp"
+
+namespace cell
+{
+
+JobPool::JobPool(std::size_t threadCount, std::size_t maxQueuedJobs)
+    : maxQueuedJobs_(maxQueuedJobs)
+{
+    if (threadCount == 0)
+        throw ExceptionWithLocation("Job pool needs at least 1 thread");
+
+    workers_.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i)
+        workers_.emplace_back([this](std::stop_token stopToken) { work(stopToken); });
+}
+
+JobPool::~JobPool()
+{
+    for (auto& worker : workers_)
+        worker.request_stop();
+    workers_.clear();
+}
+
+bool JobPool::submit(Job job)
+{
+    {
+        std::scoped_lock lock(mutex_);
+        if (jobs_.size() >= maxQueuedJobs_ + idleWorkers_)
+            return false;
+
+        jobs_.push_back(std::move(job));
+    }
+    jobAvailable_.notify_one();
+
+    return true;
+}
+
+void JobPool::work(std::stop_token stopToken)
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(mutex_);
+            ++idleWorkers_;
+            jobAvailable_.wait(lock, stopToken, [this] { return !jobs_.empty(); });
+            --idleWorkers_;
+            if (stopToken.stop_requested())
+                return;
+
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        job();
+    }
+}
+
+} // namespace cell
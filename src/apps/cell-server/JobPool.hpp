@@ -0,0 +1,57 @@
+#ifndef E648FCA3_43CA_4BC0_94EB_5BC367A32E4A_HPP
+#define E648FCA3_43CA_4BC0_94EB_5BC367A32E4A_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Fixed set of threads that run submitted jobs in submission order. The threads live as long as the pool, so
+ * jobs don't pay for starting them
+ */
+class JobPool
+{
+public:
+    using Job = std::function<void()>;
+
+public:
+    JobPool(std::size_t threadCount, std::size_t maxQueuedJobs);
+
+    /**
+     * @brief Waits for the running jobs, queued jobs are discarded
+     */
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    /**
+     * @returns false if `maxQueuedJobs` jobs are already waiting for a thread, the job is discarded then. Jobs that an
+     * idle thread is about to take don't count as waiting, so with a limit of 0 jobs are only accepted by idle threads
+     */
+    bool submit(Job job);
+
+private:
+    void work(std::stop_token stopToken);
+
+private:
+    std::size_t maxQueuedJobs_;
+    std::mutex mutex_;
+    std::condition_variable_any jobAvailable_;
+    std::deque<Job> jobs_;
+    std::size_t idleWorkers_ = 0;
+
+    // Declared last, so that the threads stop before the queue is destroyed
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace cell
+
+#endif /* E648FCA3_43CA_4BC0_94EB_5BC367A32E4A_HPP */
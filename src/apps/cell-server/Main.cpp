@@ -0,0 +1,55 @@
+#include "Server.hpp"
+
+#include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace
+{
+
+std::atomic<bool> stopRequested = false;
+
+void requestStop(int)
+{
+    stopRequested = true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Cell 1.1.1\nSimulation server for many short jobs, see Server.hpp for the protocol\nBuild time: " +
+                 std::string{__DATE__} + " " + std::string{__TIME__}};
+
+    cell::Server::Params params;
+    params.threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    app.add_option("--socket", params.socketPath, "Path of the Unix domain socket to listen on")->required();
+    app.add_option("--threads", params.threadCount,
+                   "Number of jobs that run at the same time, the number of hardware threads by default")
+        ->check(CLI::Range(1, std::numeric_limits<int>::max()));
+    app.add_option("--max-queued-jobs", params.maxQueuedJobs,
+                   "Jobs that are submitted while this many jobs are waiting for a thread are rejected, with 0 jobs "
+                   "are only accepted while a thread is idle")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--config-cache-size", params.configCacheSize,
+                   "Number of configs whose built cells are kept in memory for the next job with the same config")
+        ->check(CLI::Range(1, std::numeric_limits<int>::max()));
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    cell::Server server(params);
+    std::cout << "Listening on " << params.socketPath << " with " << params.threadCount << " threads\n";
+    server.run(stopRequested);
+    std::cout << "Shutting down\n";
+
+    return 0;
+}
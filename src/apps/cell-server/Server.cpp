@@ -0,0 +1,261 @@
+#include "Server.hpp"
+#include "cell/DataPointSink.hpp"
+#include "cell/ExceptionWithLocation.hpp"
+#include "cell/SimulationContext.hpp"
+#include "cell/SimulationFactory.hpp"
+#include "cell/SimulationRecorder.hpp"
+#include "cell/SimulationRunner.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+
+using json = nlohmann::json;
+
+namespace cell
+{
+
+namespace
+{
+// Longest time run() waits for a connection before checking whether it should stop
+constexpr int AcceptTimeoutMs = 200;
+
+ch::nanoseconds toNanoseconds(double seconds)
+{
+    return ch::duration_cast<ch::nanoseconds>(ch::duration<double>{seconds});
+}
+
+double toSeconds(const ch::nanoseconds& duration)
+{
+    return ch::duration<double>(duration).count();
+}
+
+json toJson(const SimulationRunner::PerformanceData& data)
+{
+    return json{{"targetScale", data.targetScale},
+                {"actualScale", data.actualScale},
+                {"timePerWholeUpdate", toSeconds(data.timePerWholeUpdate)},
+                {"timePerSimulationUpdate", toSeconds(data.timePerSimulationUpdate)},
+                {"elapsedSimulationTime", toSeconds(data.elapsedSimulationTime)},
+                {"timeStep", toSeconds(data.timeStep)},
+                {"pacingError", toSeconds(data.pacingError)},
+                {"updatesPerBatch", data.updatesPerBatch},
+                {"load", data.load},
+                {"fidelityLevel", data.fidelityLevel}};
+}
+
+json makeError(const std::optional<std::uint64_t>& jobID, const std::string& message)
+{
+    return json{{"event", "error"}, {"job", jobID ? json(*jobID) : json(nullptr)}, {"message", message}};
+}
+
+} // namespace
+
+Server::Server(Params params)
+    : params_(std::move(params))
+    , configCache_(params_.configCacheSize)
+    , jobPool_(std::make_unique<JobPool>(params_.threadCount, params_.maxQueuedJobs))
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const auto path = params_.socketPath.string();
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        throw ExceptionWithLocation("Socket path must have between 1 and " +
+                                    std::to_string(sizeof(address.sun_path) - 1) + " characters");
+    }
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    // Left behind by a server that didn't shut down cleanly, bind() fails otherwise
+    if (fs::is_socket(params_.socketPath))
+        fs::remove(params_.socketPath);
+
+    socket_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_ < 0)
+        throw ExceptionWithLocation("Couldn't create socket: " + std::string{std::strerror(errno)});
+
+    if (::bind(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(socket_, SOMAXCONN) < 0)
+    {
+        const std::string error = std::strerror(errno);
+        ::close(socket_);
+        throw ExceptionWithLocation("Couldn't listen on '" + path + "': " + error);
+    }
+}
+
+Server::~Server()
+{
+    for (auto& clientThread : clientThreads_)
+        clientThread.connection->close();
+
+    // No new jobs can be submitted after the client threads finished, and jobs of closed connections stop after their
+    // current update
+    clientThreads_.clear();
+    jobPool_.reset();
+
+    ::close(socket_);
+    std::error_code ignored;
+    fs::remove(params_.socketPath, ignored);
+}
+
+void Server::run(const std::atomic<bool>& stopRequested)
+{
+    pollfd listeningSocket{.fd = socket_, .events = POLLIN, .revents = 0};
+    while (!stopRequested)
+    {
+        const auto result = ::poll(&listeningSocket, 1, AcceptTimeoutMs);
+        if (result < 0 && errno != EINTR)
+            throw ExceptionWithLocation("Couldn't wait for connections: " + std::string{std::strerror(errno)});
+        if (result <= 0)
+            continue;
+
+        // Fails if the client gave up in the meantime, which isn't a problem of the server
+        const auto clientSocket = ::accept(socket_, nullptr, nullptr);
+        if (clientSocket < 0)
+            continue;
+
+        removeClosedConnections();
+        auto connection = std::make_shared<Connection>(clientSocket);
+        clientThreads_.push_back(ClientThread{
+            .connection = connection, .thread = std::jthread([this, connection] { handleConnection(connection); })});
+    }
+}
+
+void Server::handleConnection(const std::shared_ptr<Connection>& connection)
+{
+    std::string line;
+    while (connection->readLine(line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        Job job;
+        try
+        {
+            job = parseJob(line);
+        }
+        catch (const std::exception& e)
+        {
+            connection->send(makeError(std::nullopt, e.what()));
+            continue;
+        }
+
+        // A free thread might start the job right away, it waits until "queued" was sent so that the events arrive in
+        // order
+        job.ID = nextJobID_++;
+        std::promise<void> queued;
+        connection->beginJob();
+        const auto submitted = jobPool_->submit(
+            [this, job, connection, queuedEventSent = queued.get_future().share()]
+            {
+                queuedEventSent.wait();
+                runJob(job, connection);
+                connection->endJob();
+            });
+
+        if (submitted)
+            connection->send(json{{"event", "queued"}, {"job", job.ID}});
+        else
+        {
+            connection->send(json{{"event", "rejected"},
+                                  {"job", job.ID},
+                                  {"message", "Too many queued jobs, try again later"}});
+            connection->endJob();
+        }
+        queued.set_value();
+    }
+
+    connection->endInput();
+}
+
+Server::Job Server::parseJob(const std::string& line) const
+{
+    const auto j = json::parse(line);
+
+    Job job;
+    job.simulationConfig = j.at("config").get<SimulationConfig>();
+    job.duration = j.at("duration").get<double>();
+    job.storageInterval = j.at("storageInterval").get<double>();
+    job.outFile = j.at("out").get<std::string>();
+    if (j.contains("seed"))
+        job.seed = j["seed"].get<std::uint64_t>();
+
+    // Jobs already run in parallel on the threads of the job pool, more threads per job would only compete for cores
+    job.simulationConfig.workerThreads = 1;
+
+    if (job.duration <= 0 || job.storageInterval <= 0)
+        throw ExceptionWithLocation("Duration and storage interval must be > 0");
+
+    // Cheap compared to building, so invalid configs are rejected before they take up a place in the queue
+    SimulationFactory::validateSimulationConfig(job.simulationConfig);
+
+    return job;
+}
+
+void Server::runJob(const Job& job, const std::shared_ptr<Connection>& connection)
+{
+    if (connection->isClosed())
+        return;
+
+    try
+    {
+        const auto start = ch::steady_clock::now();
+        bool configWasCached = false;
+        const auto builtConfig = configCache_.get(job.simulationConfig, configWasCached);
+
+        SimulationRunner simulationRunner;
+        simulationRunner.useReplicaOf(*builtConfig, job.simulationConfig);
+        simulationRunner.setSimulationDuration(toNanoseconds(job.duration));
+        simulationRunner.setRandomSeed(job.seed);
+
+        const auto& discTypeRegistry = simulationRunner.getSimulationContext().discTypeRegistry;
+        SimulationRecorder simulationRecorder(discTypeRegistry, job.simulationConfig.mostProbableSpeed);
+        simulationRecorder.setStorageInterval(toNanoseconds(job.storageInterval));
+        simulationRecorder.setDataPointSink(std::make_unique<TypeCountsCsvSink>(job.outFile, discTypeRegistry));
+        simulationRecorder.processInitialSimulationData(simulationRunner.getCell());
+
+        simulationRunner.setPostUpdateCallback(
+            [&](Cell& cell, const ch::nanoseconds& elapsedTime)
+            {
+                simulationRecorder.processSimulationData(cell, elapsedTime);
+                if (connection->isClosed())
+                    simulationRunner.stopSimulation();
+            });
+        simulationRunner.setPerformanceDataCallback(
+            [&](SimulationRunner::PerformanceData data)
+            {
+                connection->send(json{{"event", "performance"},
+                                      {"job", job.ID},
+                                      {"progress", toSeconds(data.elapsedSimulationTime) / job.duration},
+                                      {"data", toJson(data)}});
+            });
+
+        connection->send(json{{"event", "started"}, {"job", job.ID}, {"configWasCached", configWasCached}});
+        simulationRunner.runSimulation();
+        simulationRunner.waitForSimulationToFinish();
+        simulationRecorder.storeRemainingData();
+
+        connection->send(json{{"event", "finished"},
+                              {"job", job.ID},
+                              {"realTime", toSeconds(ch::steady_clock::now() - start)}});
+    }
+    catch (const std::exception& e)
+    {
+        connection->send(makeError(job.ID, e.what()));
+    }
+}
+
+void Server::removeClosedConnections()
+{
+    // Destroying the threads joins them, their connections are closed, so they're about to finish anyway
+    std::erase_if(clientThreads_, [](const ClientThread& clientThread) { return clientThread.connection->isClosed(); });
+}
+
+} // namespace cell
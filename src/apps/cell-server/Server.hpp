@@ -0,0 +1,111 @@
+#ifndef FF919DAD_EB2E_4A7C_9F35_C04765F1EF1C_HPP
+#define FF919DAD_EB2E_4A7C_9F35_C04765F1EF1C_HPP
+
+#include "ConfigCache.hpp"
+#include "Connection.hpp"
+#include "JobPool.hpp"
+
+#include "cell/SimulationConfig.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace cell
+{
+
+/**
+ * @brief Runs simulation jobs for clients that connect to a Unix domain socket, on a fixed number of threads and with
+ * the cells of recent configs kept in memory, so that many short jobs don't each pay for starting a process and
+ * building their cell.
+ *
+ * Clients send one job per line as json:
+ *
+ * {"config": <config like in config files>, "duration": <s>, "storageInterval": <s>, "out": <csv path>, "seed": <n>}
+ *
+ * "seed" is optional and "workerThreads" of the config is ignored, each job runs on a single thread. The type counts
+ * are written to "out" like with cell-cli. The server answers with one json message per line, all of them with an
+ * "event" and the "job" ID the server assigned:
+ *
+ * - queued: The job waits for a free thread
+ * - rejected: Too many jobs are waiting already, see "message". The job isn't run, it can be sent again later
+ * - started: The job runs, "configWasCached" tells whether its cell was copied from a cached one
+ * - performance: Progress as fraction of the duration in "progress" and the performance data of the runner in "data",
+ *   about once per second
+ * - finished: "realTime" is the time in seconds it took to build and run the job
+ * - error: The job failed, see "message". "job" is null if the line couldn't be parsed as a job
+ *
+ * A client may shut down its sending side after the last job and still gets all replies, the server closes the
+ * connection after the last job ended. Jobs of a client that disconnects are stopped
+ */
+class Server
+{
+public:
+    struct Params
+    {
+        fs::path socketPath;
+        std::size_t threadCount = 1;
+        std::size_t maxQueuedJobs = 10000;
+        std::size_t configCacheSize = 16;
+    };
+
+public:
+    explicit Server(Params params);
+
+    /**
+     * @brief Closes all connections, waits for the running jobs to stop and removes the socket file
+     */
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * @brief Accepts connections until `stopRequested` is set, which is checked a few times per second
+     */
+    void run(const std::atomic<bool>& stopRequested);
+
+private:
+    struct Job
+    {
+        std::uint64_t ID = 0;
+        SimulationConfig simulationConfig;
+        double duration = 0;
+        double storageInterval = 0;
+        fs::path outFile;
+        std::optional<std::uint64_t> seed;
+    };
+
+    struct ClientThread
+    {
+        std::shared_ptr<Connection> connection;
+        std::jthread thread;
+    };
+
+private:
+    void handleConnection(const std::shared_ptr<Connection>& connection);
+    Job parseJob(const std::string& line) const;
+    void runJob(const Job& job, const std::shared_ptr<Connection>& connection);
+    void removeClosedConnections();
+
+private:
+    Params params_;
+    int socket_ = -1;
+    std::atomic<std::uint64_t> nextJobID_ = 1;
+    ConfigCache configCache_;
+
+    std::vector<ClientThread> clientThreads_;
+
+    // Declared last, so that running jobs are stopped before anything they use is destroyed
+    std::unique_ptr<JobPool> jobPool_;
+};
+
+} // namespace cell
+
+#endif /* FF919DAD_EB2E_4A7C_9F35_C04765F1EF1C_HPP */
@@ -8,4 +8,12 @@ Cell::Cell(Membrane membrane, SimulationContext simulationContext)
 {
 }
 
+std::unique_ptr<Cell> Cell::clone(SimulationContext simulationContext) const
+{
+    auto cell = std::make_unique<Cell>(getMembrane(), std::move(simulationContext));
+    cell->copyContentsOf(*this);
+
+    return cell;
+}
+
 } // namespace cell
\ No newline at end of file
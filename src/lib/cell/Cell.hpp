@@ -12,6 +12,12 @@ class Cell : public Compartment
 {
 public:
     Cell(Membrane membrane, SimulationContext simulationContext);
+
+    /**
+     * @brief Deep copy of the compartment tree and all discs that uses the given context, which may share its type
+     * registries with the context of this cell
+     */
+    std::unique_ptr<Cell> clone(SimulationContext simulationContext) const;
 };
 
 } // namespace cell
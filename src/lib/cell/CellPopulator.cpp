@@ -2,8 +2,11 @@
 #include "Cell.hpp"
 #include "Disc.hpp"
 #include "MathUtils.hpp"
+#include "PoissonDiscSampler.hpp"
+#include "WorkerPool.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <numbers>
 #include <random>
@@ -12,12 +15,27 @@
 namespace cell
 {
 
+namespace
+{
+/**
+ * @returns [begin, end) of the grid indices i with origin + spacing * (i + 1) in [min, max], possibly a bit more
+ */
+std::pair<int, int> gridIndexRange(double min, double max, double origin, double spacing, int count)
+{
+    const auto clampIndex = [&](double index)
+    { return static_cast<int>(std::clamp(index, 0.0, static_cast<double>(count))); };
+
+    return {clampIndex(std::floor((min - origin) / spacing) - 1), clampIndex(std::ceil((max - origin) / spacing))};
+}
+} // namespace
+
 CellPopulator::CellPopulator(Cell& cell, SimulationConfig simulationConfig, const DiscTypeRegistry& discTypeRegistry,
-                             const MembraneTypeRegistry& membraneTypeRegistry)
+                             const MembraneTypeRegistry& membraneTypeRegistry, WorkerPool& workerPool)
     : cell_(cell)
     , simulationConfig_(std::move(simulationConfig))
     , discTypeRegistry_(discTypeRegistry)
     , membraneTypeRegistry_(membraneTypeRegistry)
+    , workerPool_(workerPool)
 {
 }
 
@@ -29,6 +47,23 @@ void CellPopulator::populateCell()
         populateDirectly();
 }
 
+void CellPopulator::validate()
+{
+    if (simulationConfig_.useDistribution)
+    {
+        planPopulations();
+        return;
+    }
+
+    for (const auto& disc : simulationConfig_.discs)
+    {
+        discTypeRegistry_.getIDFor(disc.discTypeName);
+        if (disc.compartment < -1 || disc.compartment > static_cast<int>(simulationConfig_.membranes.size()))
+            throw ExceptionWithLocation("Invalid compartment " + std::to_string(disc.compartment) + " of disc at (" +
+                                        std::to_string(disc.x) + ", " + std::to_string(disc.y) + ")");
+    }
+}
+
 void CellPopulator::populateWithDistributions()
 {
     const auto& discTypes = simulationConfig_.discTypes;
@@ -40,7 +75,30 @@ void CellPopulator::populateWithDistributions()
                                         { return lhs.radius < rhs.radius; })
                            ->radius;
 
-    populateCompartmentWithDistribution(cell_, maxRadius);
+    // Everything that can throw happens up front, the compartments are independent of each other afterwards
+    auto populations = planPopulations();
+
+    workerPool_.parallelFor(populations.size(), 1,
+                            [&](std::size_t begin, std::size_t end)
+                            {
+                                for (std::size_t i = begin; i < end; ++i)
+                                {
+                                    if (simulationConfig_.populationMode == config::PopulationMode::PoissonDisc)
+                                        populateCompartmentWithPoissonDiscs(populations[i], maxRadius);
+                                    else
+                                        populateCompartmentWithDistribution(populations[i], maxRadius);
+                                }
+                            });
+
+    for (const auto& population : populations)
+    {
+        if (population.positionCount < static_cast<std::size_t>(population.discCount))
+        {
+            const auto& membraneTypeID = population.compartment->getMembrane().getTypeID();
+            std::cout << "\"" << membraneTypeRegistry_.getByID(membraneTypeID).getName() << "\" can only fit "
+                      << population.positionCount << "/" << population.discCount << " discs\n";
+        }
+    }
 }
 
 void CellPopulator::populateDirectly()
@@ -51,7 +109,8 @@ void CellPopulator::populateDirectly()
         newDisc.setPosition({disc.x, disc.y});
         newDisc.setVelocity({disc.vx, disc.vy});
 
-        auto& compartment = findDeepestContainingCompartment(newDisc);
+        auto& compartment =
+            disc.compartment < 0 ? findDeepestContainingCompartment(newDisc) : findCompartment(disc.compartment);
         compartment.addDisc(std::move(newDisc));
     }
 }
@@ -62,58 +121,94 @@ double CellPopulator::calculateDistributionSum(const std::map<std::string, doubl
                            [](double currentSum, auto& entryPair) { return currentSum + entryPair.second; });
 }
 
-std::vector<Vector2d> CellPopulator::calculateCompartmentGridPoints(Compartment& compartment, double maxRadius,
-                                                                    int discCount) const
+std::vector<Vector2d> CellPopulator::calculateCompartmentGridPoints(const Compartment& compartment,
+                                                                    double maxRadius) const
 {
-    const auto& membraneType = membraneTypeRegistry_.getByID(compartment.getMembrane().getTypeID());
     const auto& membraneCenter = compartment.getMembrane().getPosition();
-    const auto& membraneRadius = membraneType.getRadius();
-
-    auto gridPoints = mathutils::calculateGrid(2 * membraneRadius, 2 * membraneRadius, 2 * maxRadius);
-
-    const auto& topLeft = membraneCenter - Vector2d{membraneRadius, membraneRadius};
-    for (size_t i = 0; i < gridPoints.size();)
+    const auto membraneRadius = membraneTypeRegistry_.getByID(compartment.getMembrane().getTypeID()).getRadius();
+
+    // Same grid as mathutils::calculateGrid() over the bounding square of the membrane
+    const double spacing = 2 * maxRadius + 1;
+    const int n = static_cast<int>(2 * membraneRadius / spacing);
+    const auto topLeft = membraneCenter - Vector2d{membraneRadius, membraneRadius};
+    const auto gridPoint = [&](int i, int j)
+    { return topLeft + Vector2d{spacing * static_cast<double>(i + 1), spacing * static_cast<double>(j + 1)}; };
+    const auto gridIndex = [n](int i, int j)
+    { return static_cast<std::size_t>(j) * static_cast<std::size_t>(n) + static_cast<std::size_t>(i); };
+
+    // Sub-compartments are rasterized onto the grid, so each one only touches the grid points close to it
+    std::vector<char> blocked(static_cast<std::size_t>(n) * static_cast<std::size_t>(n), 0);
+    for (const auto& subCompartment : compartment.getCompartments())
     {
-        gridPoints[i] += topLeft;
-        bool valid = true;
+        const auto& M = subCompartment->getMembrane().getPosition();
+        const auto R = membraneTypeRegistry_.getByID(subCompartment->getMembrane().getTypeID()).getRadius();
+        const auto reach = R + maxRadius;
+        const auto [iBegin, iEnd] = gridIndexRange(M.x - reach, M.x + reach, topLeft.x, spacing, n);
+        const auto [jBegin, jEnd] = gridIndexRange(M.y - reach, M.y + reach, topLeft.y, spacing, n);
 
-        if (!mathutils::circleIsFullyContainedByCircle(gridPoints[i], maxRadius, membraneCenter, membraneRadius))
-            valid = false;
-
-        const auto& subCompartments = compartment.getCompartments();
-        for (auto iter = subCompartments.begin(); valid && iter != subCompartments.end(); ++iter)
+        for (int j = jBegin; j < jEnd; ++j)
         {
-            const auto& membrane = (*iter)->getMembrane();
-            const auto& M = membrane.getPosition();
-            const auto& R = membraneTypeRegistry_.getByID(membrane.getTypeID()).getRadius();
-
-            if (mathutils::circlesOverlap(gridPoints[i], maxRadius, M, R))
-                valid = false;
+            for (int i = iBegin; i < iEnd; ++i)
+            {
+                if (mathutils::circlesOverlap(gridPoint(i, j), maxRadius, M, R))
+                    blocked[gridIndex(i, j)] = 1;
+            }
         }
+    }
 
-        if (!valid)
+    // Row by row, only the part of the row inside the membrane is visited
+    std::vector<Vector2d> gridPoints;
+    const double innerRadius = membraneRadius - maxRadius;
+    for (int j = 0; j < n && innerRadius > 0; ++j)
+    {
+        const double dy = gridPoint(0, j).y - membraneCenter.y;
+        if (dy * dy >= innerRadius * innerRadius)
+            continue;
+
+        const double halfWidth = std::sqrt(innerRadius * innerRadius - dy * dy);
+        const auto [iBegin, iEnd] =
+            gridIndexRange(membraneCenter.x - halfWidth, membraneCenter.x + halfWidth, topLeft.x, spacing, n);
+
+        for (int i = iBegin; i < iEnd; ++i)
         {
-            std::swap(gridPoints[i], gridPoints.back());
-            gridPoints.pop_back();
+            const auto point = gridPoint(i, j);
+            if (!blocked[gridIndex(i, j)] &&
+                mathutils::circleIsFullyContainedByCircle(point, maxRadius, membraneCenter, membraneRadius))
+                gridPoints.push_back(point);
         }
-        else
-            ++i;
     }
 
-    if (static_cast<int>(gridPoints.size()) < discCount)
-    {
-        std::cout << "Grid for \"" << membraneType.getName() << "\" can only fit " << gridPoints.size() << "/"
-                  << discCount << " discs\n";
-    }
+    static thread_local std::mt19937 gen(std::random_device{}());
+    std::shuffle(gridPoints.begin(), gridPoints.end(), gen);
 
     return gridPoints;
 }
 
-void CellPopulator::populateCompartmentWithDistribution(Compartment& compartment, double maxRadius)
+std::vector<CellPopulator::CompartmentPopulation> CellPopulator::planPopulations()
 {
-    for (auto& subCompartment : compartment.getCompartments())
-        populateCompartmentWithDistribution(*subCompartment, maxRadius);
+    std::vector<CompartmentPopulation> populations;
+    if (simulationConfig_.discTypes.empty())
+        return populations;
+
+    std::vector<Compartment*> compartments({&cell_});
+    while (!compartments.empty())
+    {
+        Compartment* compartment = compartments.back();
+        compartments.pop_back();
 
+        for (auto& subCompartment : compartment->getCompartments())
+            compartments.push_back(subCompartment.get());
+
+        auto population = planCompartmentPopulation(*compartment);
+        if (population.discCount > 0)
+            populations.push_back(std::move(population));
+    }
+
+    return populations;
+}
+
+CellPopulator::CompartmentPopulation CellPopulator::planCompartmentPopulation(Compartment& compartment)
+{
     const auto& membraneTypeName = membraneTypeRegistry_.getByID(compartment.getMembrane().getTypeID()).getName();
 
     const auto& membraneType = findMembraneTypeByName(simulationConfig_, membraneTypeName);
@@ -123,23 +218,30 @@ void CellPopulator::populateCompartmentWithDistribution(Compartment& compartment
         throw ExceptionWithLocation("Disc count for membrane type \"" + membraneTypeName + "\" is negative (" +
                                     std::to_string(membraneType.discCount) + ")");
 
+    CompartmentPopulation population{.compartment = &compartment};
     if (membraneType.discCount == 0 || distribution.empty())
-        return;
+        return population;
 
-    auto gridPoints = calculateCompartmentGridPoints(compartment, maxRadius, membraneType.discCount);
-    const auto discCount = std::min(static_cast<std::size_t>(membraneType.discCount), gridPoints.size());
-
-    if (!distribution.empty())
-    {
-        if (double sum = calculateValueSum(distribution) * 100; std::abs(sum - 100) > 1e-1)
-            throw ExceptionWithLocation("Distribution for membrane type \"" + membraneTypeName +
-                                        "\" doesn't add up to 100%, it adds up to " + std::to_string(sum) + "%");
-    }
+    if (double sum = calculateValueSum(distribution) * 100; std::abs(sum - 100) > 1e-1)
+        throw ExceptionWithLocation("Distribution for membrane type \"" + membraneTypeName +
+                                    "\" doesn't add up to 100%, it adds up to " + std::to_string(sum) + "%");
 
+    population.discCount = membraneType.discCount;
     for (const auto& [discTypeName, frequency] : distribution)
+        population.distribution.emplace_back(discTypeRegistry_.getIDFor(discTypeName), frequency);
+
+    return population;
+}
+
+void CellPopulator::populateCompartmentWithDistribution(CompartmentPopulation& population, double maxRadius) const
+{
+    auto gridPoints = calculateCompartmentGridPoints(*population.compartment, maxRadius);
+    population.positionCount = gridPoints.size();
+    const auto discCount = std::min(static_cast<std::size_t>(population.discCount), gridPoints.size());
+
+    for (const auto& [discTypeID, frequency] : population.distribution)
     {
         const auto count = static_cast<int>(std::round(frequency * static_cast<double>(discCount)));
-        const auto discTypeID = discTypeRegistry_.getIDFor(discTypeName);
         const auto& discType = discTypeRegistry_.getByID(discTypeID);
 
         for (int i = 0; i < count && !gridPoints.empty(); ++i)
@@ -149,12 +251,74 @@ void CellPopulator::populateCompartmentWithDistribution(Compartment& compartment
             newDisc.setVelocity(
                 sampleVelocityFromDistribution(simulationConfig_.mostProbableSpeed, discType.getMass()));
 
-            compartment.addDisc(std::move(newDisc));
+            population.compartment->addDisc(std::move(newDisc));
             gridPoints.pop_back();
         }
     }
 }
 
+void CellPopulator::populateCompartmentWithPoissonDiscs(CompartmentPopulation& population, double maxRadius) const
+{
+    auto& compartment = *population.compartment;
+    const auto& membrane = compartment.getMembrane();
+
+    PoissonDiscSampler::Params params{
+        .container = {.center = membrane.getPosition(),
+                      .radius = membraneTypeRegistry_.getByID(membrane.getTypeID()).getRadius()},
+        .maxDiscRadius = maxRadius};
+
+    for (const auto& subCompartment : compartment.getCompartments())
+    {
+        const auto& subMembrane = subCompartment->getMembrane();
+        params.obstacles.push_back({.center = subMembrane.getPosition(),
+                                    .radius = membraneTypeRegistry_.getByID(subMembrane.getTypeID()).getRadius()});
+    }
+
+    // The types are shuffled so that if not all discs fit, each type loses about the same fraction
+    std::vector<DiscTypeID> discTypeIDs;
+    for (const auto& [discTypeID, frequency] : population.distribution)
+    {
+        const auto count = static_cast<std::size_t>(std::round(frequency * population.discCount));
+        discTypeIDs.insert(discTypeIDs.end(), count, discTypeID);
+    }
+
+    static thread_local std::mt19937 gen(std::random_device{}());
+    std::shuffle(discTypeIDs.begin(), discTypeIDs.end(), gen);
+
+    std::vector<double> radii;
+    radii.reserve(discTypeIDs.size());
+    for (const auto discTypeID : discTypeIDs)
+        radii.push_back(discTypeRegistry_.getByID(discTypeID).getRadius());
+
+    PoissonDiscSampler sampler(std::move(params));
+    std::vector<std::size_t> placedDiscs;
+    auto positions = sampler.sample(radii, placedDiscs);
+
+    // Discs that didn't fit are skipped, the remaining ones are matched up with their positions again
+    for (std::size_t i = 0; i < placedDiscs.size(); ++i)
+    {
+        discTypeIDs[i] = discTypeIDs[placedDiscs[i]];
+        radii[i] = radii[placedDiscs[i]];
+    }
+    discTypeIDs.resize(placedDiscs.size());
+    radii.resize(placedDiscs.size());
+
+    if (simulationConfig_.populationRelaxationSweeps > 0)
+        sampler.relax(positions, radii, simulationConfig_.populationRelaxationSweeps);
+
+    population.positionCount = positions.size();
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        Disc newDisc(discTypeIDs[i]);
+        newDisc.setPosition(positions[i]);
+        newDisc.setVelocity(sampleVelocityFromDistribution(simulationConfig_.mostProbableSpeed,
+                                                           discTypeRegistry_.getByID(discTypeIDs[i]).getMass()));
+
+        compartment.addDisc(std::move(newDisc));
+    }
+}
+
 Vector2d CellPopulator::sampleVelocityFromDistribution(double mostProbableSpeed, double m) const
 {
     static thread_local std::mt19937 gen(std::random_device{}());
@@ -200,6 +364,33 @@ Compartment& CellPopulator::findDeepestContainingCompartment(const Disc& disc)
     return *compartment;
 }
 
+Compartment& CellPopulator::findCompartment(int compartmentIndex)
+{
+    if (compartmentIndex == 0)
+        return cell_;
+
+    const auto& configMembrane = simulationConfig_.membranes.at(static_cast<std::size_t>(compartmentIndex - 1));
+    const auto membraneTypeID = membraneTypeRegistry_.getIDFor(configMembrane.membraneTypeName);
+
+    // Membranes of the same type can't share a position without overlapping
+    std::vector<Compartment*> compartments{&cell_};
+    while (!compartments.empty())
+    {
+        auto* compartment = compartments.back();
+        compartments.pop_back();
+
+        const auto& membrane = compartment->getMembrane();
+        if (compartment != &cell_ && membrane.getTypeID() == membraneTypeID &&
+            membrane.getPosition().x == configMembrane.x && membrane.getPosition().y == configMembrane.y)
+            return *compartment;
+
+        for (auto& child : compartment->getCompartments())
+            compartments.push_back(child.get());
+    }
+
+    throw ExceptionWithLocation("No compartment for membrane " + std::to_string(compartmentIndex - 1));
+}
+
 double CellPopulator::calculateValueSum(const std::unordered_map<std::string, double>& distribution) const
 {
     return std::accumulate(distribution.begin(), distribution.end(), 0.0,
@@ -11,24 +11,50 @@ class Cell;
 class Compartment;
 struct SimulationConfig;
 class Disc;
+class WorkerPool;
 
 class CellPopulator
 {
 public:
     CellPopulator(Cell& cell, SimulationConfig simulationConfig, const DiscTypeRegistry& discTypeRegistry,
-                  const MembraneTypeRegistry& membraneTypeRegistry);
+                  const MembraneTypeRegistry& membraneTypeRegistry, WorkerPool& workerPool);
 
     void populateCell();
 
+    /**
+     * @brief Throws for everything populateCell() would throw for (unknown disc types, negative disc counts,
+     * distributions that don't add up to 100%), without creating any discs
+     */
+    void validate();
+
 private:
+    /**
+     * @brief What to put into a single compartment, checked before the compartments are populated in parallel
+     */
+    struct CompartmentPopulation
+    {
+        Compartment* compartment = nullptr;
+        int discCount = 0;
+        std::vector<std::pair<DiscTypeID, double>> distribution;
+        std::size_t positionCount = 0; // Positions found for discs, fewer than discCount if the compartment is full
+    };
+
     void populateWithDistributions();
     void populateDirectly();
     double calculateDistributionSum(const std::map<std::string, double>& distribution) const;
-    std::vector<Vector2d> calculateCompartmentGridPoints(Compartment& compartment, double maxRadius,
-                                                         int discCount) const;
-    void populateCompartmentWithDistribution(Compartment& compartment, double maxRadius);
+
+    /**
+     * @returns Shuffled points of a grid with spacing 2 * maxRadius + 1 where discs fit into the compartment without
+     * overlapping any sub-compartment
+     */
+    std::vector<Vector2d> calculateCompartmentGridPoints(const Compartment& compartment, double maxRadius) const;
+    std::vector<CompartmentPopulation> planPopulations();
+    CompartmentPopulation planCompartmentPopulation(Compartment& compartment);
+    void populateCompartmentWithDistribution(CompartmentPopulation& population, double maxRadius) const;
+    void populateCompartmentWithPoissonDiscs(CompartmentPopulation& population, double maxRadius) const;
     Vector2d sampleVelocityFromDistribution(double mostProbableSpeed, double m) const;
     Compartment& findDeepestContainingCompartment(const Disc& disc);
+    Compartment& findCompartment(int compartmentIndex);
     double calculateValueSum(const std::unordered_map<std::string, double>& distribution) const;
 
 private:
@@ -36,6 +62,7 @@ private:
     SimulationConfig simulationConfig_;
     const DiscTypeRegistry& discTypeRegistry_;
     const MembraneTypeRegistry& membraneTypeRegistry_;
+    WorkerPool& workerPool_;
 };
 
 } // namespace cell
@@ -7,8 +7,6 @@
 namespace cell
 {
 
-DiscTypeMap<int> CollisionDetector::collisionCounts_;
-
 CollisionDetector::CollisionDetector(const DiscTypeRegistry& discTypeRegistry,
                                      const MembraneTypeRegistry& membraneTypeRegistry)
     : discTypeRegistry_(discTypeRegistry)
@@ -40,8 +38,17 @@ void CollisionDetector::buildDiscIndex()
     // We guess 100 intruding discs
     discEntries_.reserve(discs.size() + 100);
 
+    maxDiscRadius_ = 0;
+
     for (std::size_t i = 0; i < discs.size(); ++i)
+    {
+        // Destroyed discs are only removed at the end of a step, sub-steps before that must ignore them
+        if (discs[i].isMarkedDestroyed())
+            continue;
+
         discEntries_.push_back(createEntry(discs[i], discTypeRegistry_, i, EntryType::Disc));
+        maxDiscRadius_ = std::max(maxDiscRadius_, discEntries_.back().radius);
+    }
 
     std::sort(discEntries_.begin(), discEntries_.end(), entryComparator_);
 }
@@ -52,7 +59,10 @@ void CollisionDetector::addIntrudingDiscsToIndex()
     const auto oldSize = discEntries_.size();
 
     for (std::size_t i = 0; i < intrudingDiscs.size(); ++i)
+    {
         discEntries_.push_back(createEntry(*intrudingDiscs[i], discTypeRegistry_, i, EntryType::IntrudingDisc));
+        maxDiscRadius_ = std::max(maxDiscRadius_, discEntries_.back().radius);
+    }
 
     auto mid = discEntries_.begin() + static_cast<ptrdiff_t>(oldSize);
     std::sort(mid, discEntries_.end(), entryComparator_);
@@ -106,16 +116,17 @@ std::vector<CollisionDetector::Collision> CollisionDetector::detectDiscMembraneC
 
 std::vector<CollisionDetector::Collision> CollisionDetector::detectDiscDiscCollisions()
 {
-    std::vector<Collision> collisions;
-    collisions.reserve(static_cast<std::size_t>(static_cast<double>(discEntries_.size()) * 0.1));
-
-    const auto getDiscPointer = [&](const Entry& entry)
+    if (params_.useContactCache)
     {
-        if (entry.type == EntryType::IntrudingDisc)
-            return (*params_.intrudingDiscs)[entry.index];
+        previousContacts_.swap(currentContacts_);
+        currentContacts_.clear();
+    }
 
-        return &(*params_.discs)[entry.index];
-    };
+    if (params_.neighborListSkin > 0)
+        return detectDiscDiscCollisionsWithNeighborList();
+
+    std::vector<Collision> collisions;
+    collisions.reserve(static_cast<std::size_t>(static_cast<double>(discEntries_.size()) * 0.1));
 
     for (std::size_t i = 0; i < discEntries_.size(); ++i)
     {
@@ -133,17 +144,140 @@ std::vector<CollisionDetector::Collision> CollisionDetector::detectDiscDiscColli
                                            MinOverlap{1e-2}))
                 continue;
 
-            collisions.push_back(Collision{
-                .disc = getDiscPointer(entry1), .otherDisc = getDiscPointer(entry2), .type = CollisionType::DiscDisc});
-
-            ++collisionCounts_[getDiscPointer(entry1)->getTypeID()];
-            ++collisionCounts_[getDiscPointer(entry2)->getTypeID()];
+            addDiscDiscCollision(collisions, getDiscPointer(entry1), getDiscPointer(entry2));
         }
     }
 
     return collisions;
 }
 
+void CollisionDetector::addDisplacement(double maxDisplacement)
+{
+    displacementSinceNeighborListBuild_ += maxDisplacement;
+}
+
+void CollisionDetector::invalidateNeighborList()
+{
+    neighborListIsValid_ = false;
+}
+
+std::vector<CollisionDetector::Collision> CollisionDetector::detectDiscDiscCollisionsWithNeighborList()
+{
+    // Pairs that were further apart than the skin can only touch once both discs moved by half of it
+    if (!neighborListIsValid_ || displacementSinceNeighborListBuild_ > params_.neighborListSkin / 2)
+        buildNeighborList();
+
+    std::vector<Collision> collisions;
+    collisions.reserve(static_cast<std::size_t>(static_cast<double>(discEntries_.size()) * 0.1));
+
+    auto& discs = *params_.discs;
+    for (const auto& pair : neighborList_)
+    {
+        auto* disc1 = &discs[pair.index1];
+        auto* disc2 = &discs[pair.index2];
+
+        if (!disc1->isMarkedDestroyed() && !disc2->isMarkedDestroyed())
+            addCollisionIfOverlapping(collisions, disc1, pair.radius1, disc2, pair.radius2);
+    }
+
+    detectIntruderCollisions(collisions);
+
+    return collisions;
+}
+
+void CollisionDetector::buildNeighborList()
+{
+    neighborList_.clear();
+    const double skin = params_.neighborListSkin;
+
+    for (std::size_t i = 0; i < discEntries_.size(); ++i)
+    {
+        const auto& entry1 = discEntries_[i];
+        if (entry1.type != EntryType::Disc)
+            continue;
+
+        for (std::size_t j = i + 1; j < discEntries_.size(); ++j)
+        {
+            const auto& entry2 = discEntries_[j];
+            if (entry2.minX > entry1.maxX + skin)
+                break;
+
+            if (entry2.type != EntryType::Disc ||
+                !mathutils::circlesOverlap(entry1.position, entry1.radius + skin / 2, entry2.position,
+                                           entry2.radius + skin / 2))
+                continue;
+
+            neighborList_.push_back(NeighborPair{
+                .index1 = entry1.index, .index2 = entry2.index, .radius1 = entry1.radius, .radius2 = entry2.radius});
+        }
+    }
+
+    displacementSinceNeighborListBuild_ = 0;
+    neighborListIsValid_ = true;
+}
+
+void CollisionDetector::detectIntruderCollisions(std::vector<Collision>& collisions)
+{
+    // Intruders change every step, so instead of being part of the neighbor list they're looked up in the index
+    for (std::size_t i = 0; i < discEntries_.size(); ++i)
+    {
+        const auto& entry1 = discEntries_[i];
+        if (entry1.type != EntryType::IntrudingDisc)
+            continue;
+
+        auto j = static_cast<std::size_t>(
+            std::lower_bound(discEntries_.begin(), discEntries_.end(), entry1.minX - 2 * maxDiscRadius_,
+                             [](const Entry& entry, double minX) { return entry.minX < minX; }) -
+            discEntries_.begin());
+
+        for (; j < discEntries_.size() && discEntries_[j].minX <= entry1.maxX; ++j)
+        {
+            const auto& entry2 = discEntries_[j];
+
+            // Pairs of 2 intruders are found from both sides
+            if (j == i || (entry2.type == EntryType::IntrudingDisc && j < i))
+                continue;
+
+            addCollisionIfOverlapping(collisions, getDiscPointer(entry1), entry1.radius, getDiscPointer(entry2),
+                                      entry2.radius);
+        }
+    }
+}
+
+void CollisionDetector::addCollisionIfOverlapping(std::vector<Collision>& collisions, Disc* disc1, double radius1,
+                                                  Disc* disc2, double radius2)
+{
+    if (mathutils::circlesOverlap(disc1->getPosition(), radius1, disc2->getPosition(), radius2, MinOverlap{1e-2}))
+        addDiscDiscCollision(collisions, disc1, disc2);
+}
+
+void CollisionDetector::addDiscDiscCollision(std::vector<Collision>& collisions, Disc* disc1, Disc* disc2)
+{
+    if (params_.useContactCache)
+    {
+        // IDs instead of pointers, since discs might have been captured by another compartment in the meantime
+        const Contact contact = std::minmax(disc1->getID(), disc2->getID());
+        currentContacts_.insert(contact);
+
+        // Resolved pairs need a few steps to separate, they shouldn't collide or react again in the meantime
+        const auto relativePosition = disc2->getPosition() - disc1->getPosition();
+        const auto relativeVelocity = disc2->getVelocity() - disc1->getVelocity();
+        if (relativePosition * relativeVelocity > 0 && previousContacts_.contains(contact))
+            return;
+    }
+
+    collisions.push_back(Collision{.disc = disc1, .otherDisc = disc2, .type = CollisionType::DiscDisc});
+    countCollision(*disc1, *disc2);
+}
+
+Disc* CollisionDetector::getDiscPointer(const Entry& entry) const
+{
+    if (entry.type == EntryType::IntrudingDisc)
+        return (*params_.intrudingDiscs)[entry.index];
+
+    return &(*params_.discs)[entry.index];
+}
+
 DiscTypeMap<int> CollisionDetector::getAndResetCollisionCounts()
 {
     auto tmp = std::move(collisionCounts_);
@@ -152,6 +286,21 @@ DiscTypeMap<int> CollisionDetector::getAndResetCollisionCounts()
     return tmp;
 }
 
+void CollisionDetector::countCollision(const Disc& disc1, const Disc& disc2)
+{
+    ++collisionCounts_[disc1.getTypeID()];
+    ++collisionCounts_[disc2.getTypeID()];
+}
+
+bool CollisionDetector::permeabilityAllowsPassing(MembraneType::Permeability permeability,
+                                                  CollisionType collisionType)
+{
+    return permeability == MembraneType::Permeability::Bidirectional ||
+           (collisionType == CollisionType::DiscChildMembrane && permeability == MembraneType::Permeability::Inward) ||
+           (collisionType == CollisionType::DiscContainingMembrane &&
+            permeability == MembraneType::Permeability::Outward);
+}
+
 bool CollisionDetector::discIsContainedByMembrane(const Entry& entry)
 {
     auto disc = (*params_.discs)[entry.index];
@@ -165,17 +314,10 @@ bool CollisionDetector::discIsContainedByMembrane(const Entry& entry)
 bool CollisionDetector::canGoThrough(Disc* disc, Membrane* membrane,
                                      CollisionDetector::CollisionType collisionType) const
 {
-    using CollisionType = CollisionDetector::CollisionType;
-
     const auto permeability =
         membraneTypeRegistry_.getByID(membrane->getTypeID()).getPermeabilityFor(disc->getTypeID());
 
-    if (permeability == MembraneType::Permeability::Bidirectional ||
-        (collisionType == CollisionType::DiscChildMembrane && permeability == MembraneType::Permeability::Inward) ||
-        (collisionType == CollisionType::DiscContainingMembrane && permeability == MembraneType::Permeability::Outward))
-        return true;
-
-    return false;
+    return permeabilityAllowsPassing(permeability, collisionType);
 }
 
 } // namespace cell
\ No newline at end of file
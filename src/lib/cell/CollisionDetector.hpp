@@ -6,8 +6,10 @@
 #include "Types.hpp"
 #include "Vector2d.hpp"
 
+#include <cstdint>
 #include <optional>
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 namespace cell
@@ -22,6 +24,14 @@ public:
         std::vector<Membrane>* membranes = nullptr;
         std::vector<Disc*>* intrudingDiscs = nullptr;
         Membrane* containingMembrane = nullptr;
+
+        // If > 0, disc-disc collisions are only searched among pairs that were closer than this margin when the
+        // neighbor list was built. The list is rebuilt once discs might have moved by more than half of it
+        double neighborListSkin = 0;
+
+        // If true, pairs that were already resolved in the last detection and are still overlapping but moving apart
+        // aren't reported (or counted) again
+        bool useContactCache = false;
     };
 
     enum class EntryType
@@ -81,25 +91,72 @@ public:
     std::vector<Collision> detectDiscMembraneCollisions();
     std::vector<Collision> detectDiscDiscCollisions();
 
-    static DiscTypeMap<int> getAndResetCollisionCounts();
+    /**
+     * @brief Adds an upper bound for the distance any disc moved since the last call, used to decide when the neighbor
+     * list needs to be rebuilt
+     */
+    void addDisplacement(double maxDisplacement);
+
+    /**
+     * @brief Needs to be called whenever discs are added or removed, since the neighbor list refers to disc indices
+     */
+    void invalidateNeighborList();
+
+    /**
+     * @returns The number of disc-disc collisions per disc type found by this detector since the last call
+     */
+    DiscTypeMap<int> getAndResetCollisionCounts();
+
+    /**
+     * @brief Adds a collision of the 2 discs to the collision counts, for engines that find collisions on their own
+     */
+    void countCollision(const Disc& disc1, const Disc& disc2);
+
+    /**
+     * @returns true if a disc with the given permeability passes through the membrane in a collision of the given type
+     */
+    static bool permeabilityAllowsPassing(MembraneType::Permeability permeability, CollisionType collisionType);
 
 private:
     template <typename ElementType, typename RegistryType>
     Entry createEntry(const ElementType& element, const RegistryType& registry, std::size_t index,
                       EntryType entryType) const;
 
+    std::vector<Collision> detectDiscDiscCollisionsWithNeighborList();
+    void buildNeighborList();
+    void detectIntruderCollisions(std::vector<Collision>& collisions);
+    void addCollisionIfOverlapping(std::vector<Collision>& collisions, Disc* disc1, double radius1, Disc* disc2,
+                                   double radius2);
+    void addDiscDiscCollision(std::vector<Collision>& collisions, Disc* disc1, Disc* disc2);
+    Disc* getDiscPointer(const Entry& entry) const;
+
     bool discIsContainedByMembrane(const Entry& entry);
     bool canGoThrough(Disc* disc, Membrane* membrane, CollisionDetector::CollisionType collisionType) const;
 
 private:
-    static DiscTypeMap<int> collisionCounts_;
-
     const DiscTypeRegistry& discTypeRegistry_;
     const MembraneTypeRegistry& membraneTypeRegistry_;
 
     std::vector<Entry> membraneEntries_;
     std::vector<Entry> discEntries_;
+    double maxDiscRadius_ = 0;
     Params params_;
+
+    struct NeighborPair
+    {
+        std::size_t index1 = 0, index2 = 0;
+        double radius1 = 0, radius2 = 0;
+    };
+
+    std::vector<NeighborPair> neighborList_;
+    double displacementSinceNeighborListBuild_ = 0;
+    bool neighborListIsValid_ = false;
+
+    using Contact = std::pair<std::uint64_t, std::uint64_t>;
+    std::unordered_set<Contact, PairHasher> previousContacts_;
+    std::unordered_set<Contact, PairHasher> currentContacts_;
+
+    DiscTypeMap<int> collisionCounts_;
 };
 
 template <typename ElementType, typename RegistryType>
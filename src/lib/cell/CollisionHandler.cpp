@@ -2,6 +2,7 @@
 #include "Disc.hpp"
 #include "MathUtils.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 namespace cell
@@ -14,10 +15,11 @@ CollisionHandler::CollisionHandler(const DiscTypeRegistry& discTypeRegistry,
 {
 }
 
-void CollisionHandler::resolveCollisions(const std::vector<CollisionDetector::Collision>& collisions) const
+double CollisionHandler::resolveCollisions(const std::vector<CollisionDetector::Collision>& collisions) const
 {
+    double maxCorrection = 0;
     if (collisions.empty())
-        return;
+        return maxCorrection;
 
     // Sweep-and-prune always returns collisions in left-to-right order
     // Handling collisions always in the same order will give the discs a drift to the left
@@ -26,13 +28,15 @@ void CollisionHandler::resolveCollisions(const std::vector<CollisionDetector::Co
     if (mathutils::getRandomInt() % 2 == 0)
     {
         for (const auto& collision : collisions)
-            handleCollision(collision);
+            maxCorrection = std::max(maxCorrection, handleCollision(collision));
     }
     else
     {
         for (const auto& collision : std::ranges::reverse_view(collisions))
-            handleCollision(collision);
+            maxCorrection = std::max(maxCorrection, handleCollision(collision));
     }
+
+    return maxCorrection;
 }
 
 CollisionHandler::CollisionContext
@@ -99,14 +103,14 @@ CollisionHandler::calculateCollisionContext(const CollisionDetector::Collision&
     return context;
 }
 
-void CollisionHandler::handleCollision(const CollisionDetector::Collision& collision) const
+double CollisionHandler::handleCollision(const CollisionDetector::Collision& collision) const
 {
     using CollisionType = CollisionDetector::CollisionType;
 
     const auto context = calculateCollisionContext(collision);
 
     if (context.skipCollision)
-        return;
+        return 0;
 
     if (context.impulseChange <= 0)
     {
@@ -116,10 +120,11 @@ void CollisionHandler::handleCollision(const CollisionDetector::Collision& colli
         switch (collision.type)
         {
         case CollisionType::DiscContainingMembrane:
-        case CollisionType::DiscChildMembrane: context.disc->move(beta * context.normal); break;
+        case CollisionType::DiscChildMembrane: context.disc->move(beta * context.normal); return beta;
         default:
             context.disc->move(-beta * context.invMass1 * context.effMass * context.normal);
             context.obj2->move(beta * context.invMass2 * context.effMass * context.normal);
+            return beta * std::max(context.invMass1, context.invMass2) * context.effMass;
         }
     }
     else
@@ -135,6 +140,8 @@ void CollisionHandler::handleCollision(const CollisionDetector::Collision& colli
             context.obj2->accelerate(context.impulseChange * context.normal * context.invMass2);
         }
     }
+
+    return 0;
 }
 
 } // namespace cell
\ No newline at end of file
@@ -33,11 +33,15 @@ private:
 public:
     explicit CollisionHandler(const DiscTypeRegistry& discTypeRegistry,
                               const MembraneTypeRegistry& membraneTypeRegistry);
-    void resolveCollisions(const std::vector<CollisionDetector::Collision>& collisions) const;
+
+    /**
+     * @returns The largest distance a disc was moved to separate it from another disc or a membrane
+     */
+    double resolveCollisions(const std::vector<CollisionDetector::Collision>& collisions) const;
 
 private:
     CollisionContext calculateCollisionContext(const CollisionDetector::Collision& collision) const;
-    void handleCollision(const CollisionDetector::Collision& collision) const;
+    double handleCollision(const CollisionDetector::Collision& collision) const;
 
 private:
     const DiscTypeRegistry& discTypeRegistry_;
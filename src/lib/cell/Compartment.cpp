@@ -2,23 +2,45 @@
 #include "CollisionDetector.hpp"
 #include "CollisionHandler.hpp"
 #include "Disc.hpp"
+#include "ExceptionWithLocation.hpp"
 #include "MathUtils.hpp"
 #include "ReactionEngine.hpp"
+#include "SimulationConfig.hpp"
+#include "WorkerPool.hpp"
+
+#include <mutex>
 
 namespace cell
 {
 
+namespace
+{
+// Threads get at least this many discs, for fewer it costs more to hand them out than to process them
+constexpr std::size_t ParallelChunkSize = 4096;
+} // namespace
+
 Compartment::Compartment(Compartment* parent, Membrane membrane, SimulationContext simulationContext)
     : parent_(parent)
     , membrane_(std::move(membrane))
     , simulationContext_(std::move(simulationContext))
     , collisionDetector_(simulationContext_.discTypeRegistry, simulationContext_.membraneTypeRegistry)
+    , eventDrivenEngine_(simulationContext_)
 {
     membrane_.setCompartment(this);
+
+    const auto& simulationConfig = simulationContext_.simulationConfig;
     collisionDetector_.setParams(CollisionDetector::Params{.discs = &discs_,
                                                            .membranes = &membranes_,
                                                            .intrudingDiscs = &intrudingDiscs_,
-                                                           .containingMembrane = &membrane_});
+                                                           .containingMembrane = &membrane_,
+                                                           .neighborListSkin = simulationConfig.neighborListSkin,
+                                                           .useContactCache = simulationConfig.useContactCache});
+    eventDrivenEngine_.setParams(EventDrivenEngine::Params{.discs = &discs_,
+                                                           .membranes = &membranes_,
+                                                           .containingMembrane = &membrane_,
+                                                           .newDiscs = &newDiscs_,
+                                                           .collisionDetector = &collisionDetector_});
+    discStatistics_ = DiscStatistics(simulationContext_.discTypeRegistry, simulationConfig.mostProbableSpeed);
 }
 
 Compartment::~Compartment() = default;
@@ -31,11 +53,36 @@ const Membrane& Compartment::getMembrane() const
 void Compartment::setDiscs(std::vector<Disc>&& discs)
 {
     discs_ = std::move(discs);
+    collisionDetector_.invalidateNeighborList();
+    discStatisticsValid_ = false;
 }
 
 void Compartment::addDisc(Disc disc)
 {
     discs_.push_back(std::move(disc));
+    collisionDetector_.invalidateNeighborList();
+    discStatisticsValid_ = false;
+}
+
+std::size_t Compartment::removeDiscsInCircle(const Vector2d& center, double radius)
+{
+    std::size_t removedDiscs = 0;
+    for (auto& compartment : compartments_)
+        removedDiscs += compartment->removeDiscsInCircle(center, radius);
+
+    const auto removedHere = std::erase_if(discs_,
+                                           [&](const Disc& disc)
+                                           {
+                                               const auto diff = disc.getPosition() - center;
+                                               return diff * diff <= radius * radius;
+                                           });
+    if (removedHere > 0)
+    {
+        collisionDetector_.invalidateNeighborList();
+        discStatisticsValid_ = false;
+    }
+
+    return removedDiscs + removedHere;
 }
 
 const std::vector<Disc>& Compartment::getDiscs() const
@@ -83,9 +130,66 @@ const Compartment* Compartment::getParent() const
 
 void Compartment::update(double dt)
 {
+    // Reactions that were changed since the last update take effect for the whole tree at once
+    if (!parent_)
+        simulationContext_.reactionEngine.activatePendingReactions();
+
+    if (simulationContext_.simulationConfig.collisionEngine == config::CollisionEngine::EventDriven)
+    {
+        eventDrivenUpdate(dt);
+        transferDiscs();
+        return;
+    }
+
+    // Only the move-and-collide kernel runs on sub-steps, destroyed discs are skipped by the index until the clean-up
+    const int substeps = simulationContext_.simulationConfig.collisionSubsteps;
+    const double substep = dt / substeps;
+    for (int i = 1; i < substeps; ++i)
+    {
+        bimolecularUpdate();
+        moveDiscs(substep);
+    }
+
     // TODO Remove recursing twice and just accept destroyed discs at the end of update?
     bimolecularUpdate();
-    unimolecularUpdate(dt);
+    unimolecularUpdate(dt, substep);
+}
+
+double Compartment::getMaxSpeedPerRadius() const
+{
+    double maxSpeedPerRadius = maxSpeedPerRadius_;
+    for (const auto& compartment : compartments_)
+        maxSpeedPerRadius = std::max(maxSpeedPerRadius, compartment->getMaxSpeedPerRadius());
+
+    return maxSpeedPerRadius;
+}
+
+DiscTypeMap<int> Compartment::getAndResetCollisionCounts()
+{
+    auto collisionCounts = collisionDetector_.getAndResetCollisionCounts();
+    for (auto& compartment : compartments_)
+    {
+        for (const auto& [discTypeID, count] : compartment->getAndResetCollisionCounts())
+            collisionCounts[discTypeID] += count;
+    }
+
+    return collisionCounts;
+}
+
+const DiscStatistics& Compartment::getDiscStatistics()
+{
+    if (!discStatisticsValid_)
+    {
+        discStatistics_.clear();
+        for (const auto& disc : discs_)
+        {
+            if (!disc.isMarkedDestroyed())
+                discStatistics_.add(disc);
+        }
+        discStatisticsValid_ = true;
+    }
+
+    return discStatistics_;
 }
 
 void Compartment::bimolecularUpdate()
@@ -98,19 +202,32 @@ void Compartment::bimolecularUpdate()
         compartment->bimolecularUpdate();
 
     auto discDiscCollisions = detectDiscDiscCollisions();
-    simulationContext_.collisionHandler.resolveCollisions(discMembraneCollisions);
-    simulationContext_.collisionHandler.resolveCollisions(discDiscCollisions);
+
+    // Discs moved apart by the collision handler use up the skin of the neighbor list just like moving discs
+    const auto membraneCorrection = simulationContext_.collisionHandler.resolveCollisions(discMembraneCollisions);
+    const auto discCorrection = simulationContext_.collisionHandler.resolveCollisions(discDiscCollisions);
+    collisionDetector_.addDisplacement(membraneCorrection + discCorrection);
     simulationContext_.reactionEngine.applyBimolecularReactions(discDiscCollisions, newDiscs_);
 
     captureIntruders();
 }
 
-void Compartment::unimolecularUpdate(double dt)
+void Compartment::unimolecularUpdate(double dt, double moveTime)
+{
+    for (auto& compartment : compartments_)
+        compartment->unimolecularUpdate(dt, moveTime);
+
+    moveDiscsAndCleanUp(dt, moveTime);
+}
+
+void Compartment::moveDiscs(double dt)
 {
     for (auto& compartment : compartments_)
-        compartment->unimolecularUpdate(dt);
+        compartment->moveDiscs(dt);
 
-    moveDiscsAndCleanUp(dt);
+    // New discs need to take part in the next sub-step already
+    appendNewDiscs();
+    integratePositions(dt, false);
 }
 
 void Compartment::allocateMemoryForIntruders()
@@ -133,6 +250,18 @@ Compartment* Compartment::createSubCompartment(Membrane membrane)
     return compartments_.back().get();
 }
 
+void Compartment::copyContentsOf(const Compartment& source)
+{
+    if (!compartments_.empty())
+        throw ExceptionWithLocation("Contents can only be copied into a compartment without sub-compartments");
+
+    setDiscs(std::vector<Disc>(source.discs_));
+
+    compartments_.reserve(source.compartments_.size());
+    for (const auto& compartment : source.compartments_)
+        createSubCompartment(compartment->getMembrane())->copyContentsOf(*compartment);
+}
+
 std::vector<cell::CollisionDetector::Collision> Compartment::detectDiscMembraneCollisions()
 {
     collisionDetector_.buildDiscIndex();
@@ -201,6 +330,7 @@ void Compartment::captureIntruders()
             {
                 discs_.push_back(*intruder);
                 intruder->markDestroyed();
+                collisionDetector_.invalidateNeighborList();
             }
         }
     }
@@ -211,32 +341,138 @@ void Compartment::captureIntruders()
     intruderCaptureStatus_.clear();
 }
 
-void Compartment::moveDiscsAndCleanUp(double dt)
+void Compartment::eventDrivenUpdate(double dt)
+{
+    for (auto& compartment : compartments_)
+        compartment->eventDrivenUpdate(dt);
+
+    eventDrivenEngine_.advance(dt);
+    moveDiscsAndCleanUp(dt, 0);
+}
+
+void Compartment::transferDiscs()
 {
+    // Without intruders, discs change their compartment once they have completely passed a membrane
+    const auto& discTypeRegistry = simulationContext_.discTypeRegistry;
+    const auto& membraneTypeRegistry = simulationContext_.membraneTypeRegistry;
+    const auto membraneRadius = membraneTypeRegistry.getByID(membrane_.getTypeID()).getRadius();
+
     for (std::size_t i = 0; i < discs_.size(); ++i)
     {
         auto& disc = discs_[i];
-        simulationContext_.reactionEngine.applyUnimolecularReactions(disc, dt, newDiscs_);
+        const auto& position = disc.getPosition();
+        const auto discRadius = discTypeRegistry.getByID(disc.getTypeID()).getRadius();
+        Compartment* target = nullptr;
 
-        if (disc.isMarkedDestroyed())
+        if (parent_ && !mathutils::circlesOverlap(position, discRadius, membrane_.getPosition(), membraneRadius))
+            target = parent_;
+        else
         {
-            discs_[i] = std::move(discs_.back());
-            discs_.pop_back();
-            --i;
-            continue;
+            for (auto& compartment : compartments_)
+            {
+                const auto& membrane = compartment->getMembrane();
+                const auto radius = membraneTypeRegistry.getByID(membrane.getTypeID()).getRadius();
+                if (mathutils::circleIsFullyContainedByCircle(position, discRadius, membrane.getPosition(), radius))
+                {
+                    target = compartment.get();
+                    break;
+                }
+            }
         }
 
-        disc.move(disc.getVelocity() * dt);
+        if (!target)
+            continue;
+
+        // Not addDisc(), the disc was already counted in the statistics of this compartment
+        target->discs_.push_back(std::move(disc));
+        target->collisionDetector_.invalidateNeighborList();
+        discs_[i] = std::move(discs_.back());
+        discs_.pop_back();
+        --i;
     }
 
-    for (auto& disc : newDiscs_)
-        disc.move(disc.getVelocity() * dt);
+    for (auto& compartment : compartments_)
+        compartment->transferDiscs();
+}
 
-    if (!newDiscs_.empty())
+void Compartment::moveDiscsAndCleanUp(double dt, double moveTime)
+{
+    // Reactions draw random numbers and append to newDiscs_ in order, so this pass stays sequential
+    for (auto& disc : discs_)
     {
-        discs_.insert(discs_.end(), newDiscs_.begin(), newDiscs_.end());
-        newDiscs_.clear();
+        if (!disc.isMarkedDestroyed())
+            simulationContext_.reactionEngine.applyUnimolecularReactions(disc, dt, newDiscs_);
     }
+
+    if (std::erase_if(discs_, [](const Disc& disc) { return disc.isMarkedDestroyed(); }) > 0)
+        collisionDetector_.invalidateNeighborList();
+
+    appendNewDiscs();
+    maxSpeedPerRadius_ = integratePositions(moveTime, true);
+}
+
+void Compartment::appendNewDiscs()
+{
+    if (newDiscs_.empty())
+        return;
+
+    discs_.insert(discs_.end(), newDiscs_.begin(), newDiscs_.end());
+    newDiscs_.clear();
+    collisionDetector_.invalidateNeighborList();
+}
+
+double Compartment::integratePositions(double dt, bool collectStatistics)
+{
+    const auto& discTypeRegistry = simulationContext_.discTypeRegistry;
+    double maxSquaredSpeed = 0;
+    double maxSquaredSpeedPerRadius = 0;
+    std::mutex mutex;
+
+    if (collectStatistics)
+        discStatistics_.clear();
+
+    simulationContext_.workerPool.parallelFor(
+        discs_.size(), ParallelChunkSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            double chunkMaxSquaredSpeed = 0;
+            double chunkMaxSquaredSpeedPerRadius = 0;
+            DiscStatistics chunkStatistics;
+            if (collectStatistics)
+                chunkStatistics = DiscStatistics(discTypeRegistry, discStatistics_.getVSigma());
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                auto& disc = discs_[i];
+                if (disc.isMarkedDestroyed())
+                    continue;
+
+                const auto& velocity = disc.getVelocity();
+                const auto squaredSpeed = velocity * velocity;
+                const auto radius = discTypeRegistry.getByID(disc.getTypeID()).getRadius();
+
+                chunkMaxSquaredSpeed = std::max(chunkMaxSquaredSpeed, squaredSpeed);
+                chunkMaxSquaredSpeedPerRadius =
+                    std::max(chunkMaxSquaredSpeedPerRadius, squaredSpeed / (radius * radius));
+                disc.move(velocity * dt);
+
+                if (collectStatistics)
+                    chunkStatistics.add(disc);
+            }
+
+            std::scoped_lock lock(mutex);
+            maxSquaredSpeed = std::max(maxSquaredSpeed, chunkMaxSquaredSpeed);
+            maxSquaredSpeedPerRadius = std::max(maxSquaredSpeedPerRadius, chunkMaxSquaredSpeedPerRadius);
+            if (collectStatistics)
+                discStatistics_.add(chunkStatistics);
+        });
+
+    if (collectStatistics)
+        discStatisticsValid_ = true;
+
+    collisionDetector_.addDisplacement(std::sqrt(maxSquaredSpeed) * dt);
+
+    return std::sqrt(maxSquaredSpeedPerRadius);
 }
 
 } // namespace cell
\ No newline at end of file
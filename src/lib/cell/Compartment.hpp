@@ -2,6 +2,8 @@
 #define C4819342_4F4C_446A_9CDF_CA4AA5E00883_HPP
 
 #include "CollisionDetector.hpp"
+#include "DiscStatistics.hpp"
+#include "EventDrivenEngine.hpp"
 #include "Membrane.hpp"
 #include "SimulationContext.hpp"
 
@@ -26,23 +28,67 @@ public:
     const Membrane& getMembrane() const;
     void setDiscs(std::vector<Disc>&& discs);
     void addDisc(Disc disc);
+
+    /**
+     * @brief Removes the discs whose centers are inside the given circle from this compartment and all of its
+     * sub-compartments. Must not be called during an update
+     * @returns The number of removed discs
+     */
+    std::size_t removeDiscsInCircle(const Vector2d& center, double radius);
     const std::vector<Disc>& getDiscs() const;
     void addIntrudingDisc(Disc* disc, const Compartment* source, bool shouldBeCaptured);
     std::vector<std::unique_ptr<Compartment>>& getCompartments();
     const std::vector<std::unique_ptr<Compartment>>& getCompartments() const;
     const Compartment* getParent() const;
     void update(double dt);
+
+    /**
+     * @returns The largest |v|/r of all discs in this compartment and its sub-compartments, measured during the last
+     * update, in 1/s. The inverse is the time the fastest disc needs to move by its own radius
+     */
+    double getMaxSpeedPerRadius() const;
+
+    /**
+     * @returns The number of disc-disc collisions per disc type in this compartment and its sub-compartments since the
+     * last call
+     */
+    DiscTypeMap<int> getAndResetCollisionCounts();
+
+    /**
+     * @brief Statistics of the discs in this compartment (without sub-compartments), collected while they were moved
+     * during the last update. Discs that changed their compartment afterwards are still counted in the old one, so
+     * only the sum over the whole tree is meaningful. Collected in a separate pass if the discs were replaced since
+     */
+    const DiscStatistics& getDiscStatistics();
     Compartment* createSubCompartment(Membrane membrane);
 
+    /**
+     * @brief Recreates the sub-compartments of `source` in this compartment and copies all discs, recursively. Caches
+     * like the neighbor list aren't copied, they're rebuilt during the next update. This compartment must not have
+     * sub-compartments yet
+     */
+    void copyContentsOf(const Compartment& source);
+
 private:
     std::vector<cell::CollisionDetector::Collision> detectDiscMembraneCollisions();
     std::vector<cell::CollisionDetector::Collision> detectDiscDiscCollisions();
     void registerIntruders(const std::vector<CollisionDetector::Collision>& discMembraneCollisions);
     void captureIntruders();
-    void moveDiscsAndCleanUp(double dt);
+    void moveDiscsAndCleanUp(double dt, double moveTime);
+    void moveDiscs(double dt);
+    void appendNewDiscs();
+
+    /**
+     * @brief Moves all discs by dt, splitting them between the worker threads in large compartments
+     * @param collectStatistics Whether to refill the disc statistics in the same pass
+     * @returns The largest |v|/r of the moved discs
+     */
+    double integratePositions(double dt, bool collectStatistics);
     void bimolecularUpdate();
-    void unimolecularUpdate(double dt);
+    void unimolecularUpdate(double dt, double moveTime);
     void allocateMemoryForIntruders();
+    void eventDrivenUpdate(double dt);
+    void transferDiscs();
 
 private:
     Compartment* parent_;
@@ -54,8 +100,12 @@ private:
     std::vector<Membrane> membranes_;
     SimulationContext simulationContext_;
     CollisionDetector collisionDetector_;
+    EventDrivenEngine eventDrivenEngine_;
     std::size_t intruderAllocationCount_ = 0;
     std::vector<Disc> newDiscs_;
+    double maxSpeedPerRadius_ = 0;
+    DiscStatistics discStatistics_;
+    bool discStatisticsValid_ = false;
 };
 
 } // namespace cell
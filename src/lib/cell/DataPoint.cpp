@@ -53,23 +53,84 @@ void DataPoint::average(NormalizeCollisionCounts normalizeCollisionCounts)
 
 void DataPoint::initializeHistograms(const std::vector<DiscTypeID>& discTypeIDs, double vSigma)
 {
-    data_.vxHistogram = bh::make_histogram(bh::axis::category<DiscTypeID>(discTypeIDs, "Disc type"),
-                                           bh::axis::regular<>(20, -3 * vSigma, 3 * vSigma, "v_x"));
+    const auto bins = DiscStatistics::HistogramBins;
+    const auto componentLimit = DiscStatistics::VelocityComponentRange * vSigma;
 
-    data_.vyHistogram = bh::make_histogram(bh::axis::category<DiscTypeID>(discTypeIDs, "Disc type"),
-                                           bh::axis::regular<>(20, -3 * vSigma, 3 * vSigma, "v_y"));
-
-    data_.vHistogram = bh::make_histogram(bh::axis::category<DiscTypeID>(discTypeIDs, "Disc type"),
-                                          bh::axis::regular<>(20, 0, 4 * vSigma, "v"));
+    data_.vxHistogram = DenseHistogram(discTypeIDs, bins, -componentLimit, componentLimit, "v_x");
+    data_.vyHistogram = DenseHistogram(discTypeIDs, bins, -componentLimit, componentLimit, "v_y");
+    data_.vHistogram = DenseHistogram(discTypeIDs, bins, 0, DiscStatistics::SpeedRange * vSigma, "v");
 }
 
-void DataPoint::addSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime,
-                                  const DiscTypeRegistry& discTypeRegistry)
+bool DataPoint::addSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime)
 {
-    addMapToMap(data_.collisionCounts, CollisionDetector::getAndResetCollisionCounts());
+    addMapToMap(data_.collisionCounts, cell.getAndResetCollisionCounts());
     data_.elapsedTime += elapsedTime;
 
-    std::unordered_map<DiscTypeID, cell::Vector2d> momentumMap;
+    // The compartments collected their statistics while moving the discs, so only these need to be added up
+    DiscStatistics statistics;
+    std::vector<Compartment*> compartments({&cell});
+    while (!compartments.empty())
+    {
+        Compartment* compartment = compartments.back();
+        compartments.pop_back();
+
+        statistics.add(compartment->getDiscStatistics());
+
+        for (const auto& subCompartment : compartment->getCompartments())
+            compartments.push_back(subCompartment.get());
+    }
+
+    const bool histogramsMatch = histogramsMatchStatistics(statistics.getVSigma());
+    const auto& typeStatistics = statistics.getTypeStatistics();
+    for (std::size_t i = 0; i < typeStatistics.size(); ++i)
+    {
+        const auto& discTypeStatistics = typeStatistics[i];
+        if (discTypeStatistics.count == 0)
+            continue;
+
+        const auto discTypeID = static_cast<DiscTypeID>(i);
+        data_.discTypeCounts[discTypeID] += static_cast<double>(discTypeStatistics.count);
+        data_.totalKineticEnergies[discTypeID] += discTypeStatistics.kineticEnergy;
+        data_.totalMomentums[discTypeID] = mathutils::abs(discTypeStatistics.momentum);
+
+        if (histogramsMatch)
+        {
+            data_.vxHistogram.addCounts(discTypeID, discTypeStatistics.vxCounts);
+            data_.vyHistogram.addCounts(discTypeID, discTypeStatistics.vyCounts);
+            data_.vHistogram.addCounts(discTypeID, discTypeStatistics.vCounts);
+        }
+    }
+
+    if (!histogramsMatch)
+        fillHistogramsFromDiscs(cell);
+
+    ++n_;
+
+    return histogramsMatch;
+}
+
+bool DataPoint::histogramsMatchStatistics(double vSigma) const
+{
+    const auto matches = [](const DenseHistogram& histogram, double min, double max)
+    {
+        return histogram.getBinCount() == DiscStatistics::HistogramBins && histogram.getMin() == min &&
+               histogram.getMax() == max;
+    };
+
+    const auto componentLimit = DiscStatistics::VelocityComponentRange * vSigma;
+
+    return matches(data_.vxHistogram, -componentLimit, componentLimit) &&
+           matches(data_.vyHistogram, -componentLimit, componentLimit) &&
+           matches(data_.vHistogram, 0, DiscStatistics::SpeedRange * vSigma);
+}
+
+void DataPoint::fillHistogramsFromDiscs(const Cell& cell)
+{
+    std::vector<DiscTypeID> discTypeIDs;
+    std::vector<double> vx;
+    std::vector<double> vy;
+    std::vector<double> v;
+
     std::vector<const Compartment*> compartments({&cell});
     while (!compartments.empty())
     {
@@ -78,25 +139,19 @@ void DataPoint::addSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime
 
         for (const auto& disc : compartment->getDiscs())
         {
-            const auto discTypeID = disc.getTypeID();
-            const auto mass = discTypeRegistry.getByID(disc.getTypeID()).getMass();
-
-            ++data_.discTypeCounts[discTypeID];
-            data_.totalKineticEnergies[discTypeID] += disc.getKineticEnergy(mass);
-            momentumMap[discTypeID] += disc.getMomentum(mass);
-            data_.vxHistogram(discTypeID, disc.getVelocity().x);
-            data_.vyHistogram(discTypeID, disc.getVelocity().y);
-            data_.vHistogram(discTypeID, mathutils::abs(disc.getVelocity()));
+            discTypeIDs.push_back(disc.getTypeID());
+            vx.push_back(disc.getVelocity().x);
+            vy.push_back(disc.getVelocity().y);
+            v.push_back(mathutils::abs(disc.getVelocity()));
         }
 
         for (const auto& subCompartment : compartment->getCompartments())
             compartments.push_back(subCompartment.get());
     }
 
-    for (const auto& [discTypeID, momentum] : momentumMap)
-        data_.totalMomentums[discTypeID] = mathutils::abs(momentum);
-
-    ++n_;
+    data_.vxHistogram.fill(discTypeIDs, vx);
+    data_.vyHistogram.fill(discTypeIDs, vy);
+    data_.vHistogram.fill(discTypeIDs, v);
 }
 
 } // namespace cell
\ No newline at end of file
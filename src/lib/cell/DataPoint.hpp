@@ -3,23 +3,20 @@
 
 #include "Cell.hpp"
 #include "CollisionDetector.hpp"
+#include "DenseHistogram.hpp"
+#include "DiscStatistics.hpp"
 #include "MathUtils.hpp"
 #include "Types.hpp"
 
-#include <boost/histogram.hpp>
-
 #include <chrono>
 #include <string>
 #include <unordered_map>
 
 namespace ch = std::chrono;
-namespace bh = boost::histogram;
 
 namespace cell
 {
 
-using Histogram = bh::histogram<std::tuple<bh::axis::category<DiscTypeID>, bh::axis::regular<>>, bh::default_storage>;
-
 struct NormalizeCollisionCounts
 {
     bool value = true;
@@ -48,9 +45,9 @@ public:
         std::unordered_map<DiscTypeID, double> totalMomentums;
         std::unordered_map<DiscTypeID, double> totalKineticEnergies;
         std::unordered_map<DiscTypeID, double> discTypeCounts;
-        Histogram vxHistogram;
-        Histogram vyHistogram;
-        Histogram vHistogram;
+        DenseHistogram vxHistogram;
+        DenseHistogram vyHistogram;
+        DenseHistogram vHistogram;
     };
 
 public:
@@ -59,7 +56,20 @@ public:
     void add(const DataPoint& rhs);
     void average(NormalizeCollisionCounts normalizeCollisionCounts = {});
     void initializeHistograms(const std::vector<DiscTypeID>& discTypeIDs, double vSigma);
-    void addSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime, const DiscTypeRegistry& discTypeRegistry);
+
+    /**
+     * @returns true if the velocity histograms were taken from the statistics of the compartments, false if they needed
+     * a separate pass over all discs
+     */
+    bool addSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime);
+
+private:
+    bool histogramsMatchStatistics(double vSigma) const;
+
+    /**
+     * @brief Fallback for histograms that were initialized with a different vSigma than the one the compartments use
+     */
+    void fillHistogramsFromDiscs(const Cell& cell);
 
 private:
     Data data_;
@@ -0,0 +1,87 @@
+#include "DataPointSink.hpp"
+#include "ExceptionWithLocation.hpp"
+
+namespace cell
+{
+
+void DataPointSink::flush()
+{
+}
+
+void InMemoryDataPointSink::add(const DataPoint& dataPoint)
+{
+    dataPoints_.push_back(dataPoint);
+}
+
+void InMemoryDataPointSink::clear()
+{
+    dataPoints_.clear();
+}
+
+const std::deque<DataPoint>& InMemoryDataPointSink::getDataPoints() const
+{
+    return dataPoints_;
+}
+
+RingBufferDataPointSink::RingBufferDataPointSink(std::size_t capacity)
+    : capacity_(capacity)
+{
+    if (capacity_ == 0)
+        throw ExceptionWithLocation("Ring buffer capacity must be positive");
+}
+
+void RingBufferDataPointSink::add(const DataPoint& dataPoint)
+{
+    if (dataPoints_.size() == capacity_)
+        dataPoints_.pop_front();
+
+    dataPoints_.push_back(dataPoint);
+}
+
+TypeCountsCsvSink::TypeCountsCsvSink(const fs::path& outFile, const DiscTypeRegistry& discTypeRegistry)
+    : outFile_(outFile)
+    , discTypeRegistry_(discTypeRegistry)
+    , discTypeIDs_(discTypeRegistry.getIDs())
+{
+    openFile();
+}
+
+TypeCountsCsvSink::TypeCountsCsvSink(const fs::path& outFile, const DiscTypeRegistry& discTypeRegistry,
+                                     const ch::nanoseconds& startTime)
+    : outFile_(outFile)
+    , discTypeRegistry_(discTypeRegistry)
+    , discTypeIDs_(discTypeRegistry.getIDs())
+{
+    openFile(std::ios::app);
+    elapsedTime_ = startTime;
+}
+
+void TypeCountsCsvSink::add(const DataPoint& dataPoint)
+{
+    elapsedTime_ += dataPoint.getData().elapsedTime;
+    serializer_.writeTypeCountsCsvRow(file_, dataPoint, elapsedTime_, discTypeIDs_);
+}
+
+void TypeCountsCsvSink::clear()
+{
+    file_.close();
+    openFile();
+}
+
+void TypeCountsCsvSink::flush()
+{
+    file_.flush();
+}
+
+void TypeCountsCsvSink::openFile(std::ios::openmode mode)
+{
+    file_.open(outFile_, std::ios::out | mode);
+    if (!file_)
+        throw ExceptionWithLocation("Couldn't open file '" + outFile_.string() + "' for writing");
+
+    elapsedTime_ = ch::nanoseconds{0};
+    if (mode & std::ios::trunc)
+        serializer_.writeTypeCountsCsvHeader(file_, discTypeRegistry_);
+}
+
+} // namespace cell
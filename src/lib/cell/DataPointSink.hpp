@@ -0,0 +1,110 @@
+#ifndef C44DA3BC_F361_4268_A553_EC81DF9DF96A_HPP
+#define C44DA3BC_F361_4268_A553_EC81DF9DF96A_HPP
+
+#include "DataPoint.hpp"
+#include "SimulationRecordSerializer.hpp"
+#include "Types.hpp"
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace cell
+{
+
+/**
+ * @brief Receives the data points stored by the `SimulationRecorder`. Implementations decide what happens with the
+ * recorded history, i. e. how much of it is kept in memory
+ */
+class DataPointSink
+{
+public:
+    virtual ~DataPointSink() = default;
+
+    /**
+     * @brief Called for every data point the recorder stores, starting with the initial one (0 elapsed time)
+     */
+    virtual void add(const DataPoint& dataPoint) = 0;
+
+    /**
+     * @brief Discards everything recorded so far
+     */
+    virtual void clear() = 0;
+
+    /**
+     * @brief Called by the recorder once no more data points are expected for now
+     */
+    virtual void flush();
+};
+
+/**
+ * @brief Keeps every data point in memory. This is the default sink of the `SimulationRecorder`
+ */
+class InMemoryDataPointSink : public DataPointSink
+{
+public:
+    void add(const DataPoint& dataPoint) override;
+    void clear() override;
+
+    const std::deque<DataPoint>& getDataPoints() const;
+
+protected:
+    std::deque<DataPoint> dataPoints_;
+};
+
+/**
+ * @brief Keeps only the last `capacity` data points in memory, older ones are discarded
+ */
+class RingBufferDataPointSink : public InMemoryDataPointSink
+{
+public:
+    explicit RingBufferDataPointSink(std::size_t capacity);
+
+    void add(const DataPoint& dataPoint) override;
+
+private:
+    std::size_t capacity_;
+};
+
+/**
+ * @brief Writes the disc type counts of each data point to a csv file as soon as it arrives, so memory usage stays
+ * constant no matter how long the simulation runs. Produces the same output as
+ * `SimulationRecordSerializer::writeTypeCountsToCsv`
+ */
+class TypeCountsCsvSink : public DataPointSink
+{
+public:
+    TypeCountsCsvSink(const fs::path& outFile, const DiscTypeRegistry& discTypeRegistry);
+
+    /**
+     * @brief Appends to a file that was written for the same disc types, e. g. by an earlier part of the same run. The
+     * header isn't written again and elapsed times continue from `startTime`
+     */
+    TypeCountsCsvSink(const fs::path& outFile, const DiscTypeRegistry& discTypeRegistry,
+                      const ch::nanoseconds& startTime);
+
+    void add(const DataPoint& dataPoint) override;
+
+    /**
+     * @brief Truncates the output file, leaving only the header
+     */
+    void clear() override;
+    void flush() override;
+
+private:
+    void openFile(std::ios::openmode mode = std::ios::trunc);
+
+private:
+    fs::path outFile_;
+    std::ofstream file_;
+    const DiscTypeRegistry& discTypeRegistry_;
+    std::vector<DiscTypeID> discTypeIDs_;
+    ch::nanoseconds elapsedTime_{};
+    SimulationRecordSerializer serializer_;
+};
+
+} // namespace cell
+
+#endif /* C44DA3BC_F361_4268_A553_EC81DF9DF96A_HPP */
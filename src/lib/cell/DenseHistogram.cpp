@@ -0,0 +1,178 @@
+#include "DenseHistogram.hpp"
+#include "ExceptionWithLocation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cell
+{
+
+DenseHistogram::DenseHistogram(const std::vector<DiscTypeID>& discTypeIDs, int binCount, double min, double max,
+                               std::string label)
+    : discTypeIDs_(discTypeIDs)
+    , binCount_(binCount)
+    , min_(min)
+    , max_(max)
+    , label_(std::move(label))
+    , counts_(discTypeIDs.size() * static_cast<std::size_t>(binCount + 2), 0.0)
+{
+    if (binCount <= 0)
+        throw ExceptionWithLocation("Histogram needs at least 1 bin, but " + std::to_string(binCount) + " were given");
+
+    if (!(min < max))
+        throw ExceptionWithLocation("Histogram range is empty: [" + std::to_string(min) + ", " + std::to_string(max) +
+                                    ")");
+
+    for (std::size_t row = 0; row < discTypeIDs_.size(); ++row)
+    {
+        const auto discTypeID = discTypeIDs_[row];
+        if (rowIndices_.size() <= discTypeID)
+            rowIndices_.resize(discTypeID + 1, -1);
+
+        rowIndices_[discTypeID] = static_cast<int>(row);
+    }
+}
+
+std::size_t DenseHistogram::binIndex(double value, double min, double max, int binCount)
+{
+    const double index = std::floor((value - min) / (max - min) * binCount) + 1;
+    if (std::isnan(index))
+        return static_cast<std::size_t>(binCount) + 1;
+
+    return static_cast<std::size_t>(std::clamp(index, 0.0, static_cast<double>(binCount) + 1));
+}
+
+int DenseHistogram::getBinCount() const
+{
+    return binCount_;
+}
+
+double DenseHistogram::getMin() const
+{
+    return min_;
+}
+
+double DenseHistogram::getMax() const
+{
+    return max_;
+}
+
+const std::vector<DiscTypeID>& DenseHistogram::getDiscTypeIDs() const
+{
+    return discTypeIDs_;
+}
+
+double DenseHistogram::at(DiscTypeID discTypeID, int bin) const
+{
+    if (discTypeID >= rowIndices_.size() || rowIndices_[discTypeID] < 0)
+        throw ExceptionWithLocation("Histogram has no row for disc type " + std::to_string(discTypeID));
+
+    if (bin < -1 || bin > binCount_)
+        throw ExceptionWithLocation("Histogram bin out of range: " + std::to_string(bin));
+
+    return counts_[static_cast<std::size_t>(rowIndices_[discTypeID]) * static_cast<std::size_t>(binCount_ + 2) +
+                   static_cast<std::size_t>(bin + 1)];
+}
+
+void DenseHistogram::fill(DiscTypeID discTypeID, double value)
+{
+    if (auto* row = getRow(discTypeID))
+        row[binIndex(value, min_, max_, binCount_)] += 1;
+}
+
+void DenseHistogram::fill(std::span<const DiscTypeID> discTypeIDs, std::span<const double> values)
+{
+    if (discTypeIDs.size() != values.size())
+        throw ExceptionWithLocation("Histogram fill needs one disc type per value");
+
+    // Bin indices are computed in a separate loop without branches on the data, so that it can be vectorized. Same
+    // arithmetic as binIndex()
+    constexpr std::size_t BatchSize = 256;
+    std::size_t bins[BatchSize];
+    const double range = max_ - min_;
+    const double overflowIndex = binCount_ + 1;
+
+    for (std::size_t begin = 0; begin < values.size(); begin += BatchSize)
+    {
+        const auto size = std::min(BatchSize, values.size() - begin);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const double index = std::floor((values[begin + i] - min_) / range * binCount_) + 1;
+            bins[i] =
+                static_cast<std::size_t>(std::isnan(index) ? overflowIndex : std::clamp(index, 0.0, overflowIndex));
+        }
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (auto* row = getRow(discTypeIDs[begin + i]))
+                row[bins[i]] += 1;
+        }
+    }
+}
+
+void DenseHistogram::addCounts(DiscTypeID discTypeID, std::span<const std::uint64_t> counts)
+{
+    if (counts.size() != static_cast<std::size_t>(binCount_ + 2))
+        throw ExceptionWithLocation("Expected " + std::to_string(binCount_ + 2) + " counts, got " +
+                                    std::to_string(counts.size()));
+
+    auto* row = getRow(discTypeID);
+    if (!row)
+        return;
+
+    for (std::size_t bin = 0; bin < counts.size(); ++bin)
+        row[bin] += static_cast<double>(counts[bin]);
+}
+
+void DenseHistogram::reset()
+{
+    std::fill(counts_.begin(), counts_.end(), 0.0);
+}
+
+DenseHistogram& DenseHistogram::operator+=(const DenseHistogram& rhs)
+{
+    if (discTypeIDs_ != rhs.discTypeIDs_ || binCount_ != rhs.binCount_ || min_ != rhs.min_ || max_ != rhs.max_)
+        throw ExceptionWithLocation("Can't add histograms with different axes");
+
+    for (std::size_t i = 0; i < counts_.size(); ++i)
+        counts_[i] += rhs.counts_[i];
+
+    return *this;
+}
+
+DenseHistogram& DenseHistogram::operator/=(double divisor)
+{
+    for (auto& count : counts_)
+        count /= divisor;
+
+    return *this;
+}
+
+Histogram DenseHistogram::toHistogram() const
+{
+    auto histogram = bh::make_histogram(bh::axis::category<DiscTypeID>(discTypeIDs_, "Disc type"),
+                                        bh::axis::regular<>(binCount_, min_, max_, label_));
+
+    const auto rowSize = static_cast<std::size_t>(binCount_ + 2);
+    for (std::size_t row = 0; row < discTypeIDs_.size(); ++row)
+    {
+        for (int bin = -1; bin <= binCount_; ++bin)
+        {
+            const auto count = counts_[row * rowSize + static_cast<std::size_t>(bin + 1)];
+            if (count != 0)
+                histogram.at(static_cast<bh::axis::index_type>(row), bin) = count;
+        }
+    }
+
+    return histogram;
+}
+
+double* DenseHistogram::getRow(DiscTypeID discTypeID)
+{
+    if (discTypeID >= rowIndices_.size() || rowIndices_[discTypeID] < 0)
+        return nullptr;
+
+    return counts_.data() + static_cast<std::size_t>(rowIndices_[discTypeID]) * static_cast<std::size_t>(binCount_ + 2);
+}
+
+} // namespace cell
@@ -0,0 +1,80 @@
+#ifndef EFC9E74D_9DA5_451B_BD50_8C5353542490_HPP
+#define EFC9E74D_9DA5_451B_BD50_8C5353542490_HPP
+
+#include "Types.hpp"
+
+#include <boost/histogram.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bh = boost::histogram;
+
+namespace cell
+{
+
+using Histogram = bh::histogram<std::tuple<bh::axis::category<DiscTypeID>, bh::axis::regular<>>, bh::default_storage>;
+
+/**
+ * @brief Disc type x bin matrix with equally sized bins over [min, max), plus an underflow and an overflow bin per disc
+ * type. Counts are doubles so that averaged histograms can be stored in the same type
+ */
+class DenseHistogram
+{
+public:
+    DenseHistogram() = default;
+    DenseHistogram(const std::vector<DiscTypeID>& discTypeIDs, int binCount, double min, double max, std::string label);
+
+    /**
+     * @returns The index in a row of counts, 0 being the underflow bin and binCount + 1 the overflow bin. Same binning
+     * as boost::histogram::axis::regular up to rounding at the bin edges, NaN ends up in the overflow bin
+     */
+    static std::size_t binIndex(double value, double min, double max, int binCount);
+
+    int getBinCount() const;
+    double getMin() const;
+    double getMax() const;
+    const std::vector<DiscTypeID>& getDiscTypeIDs() const;
+
+    /**
+     * @param bin -1 for the underflow bin, binCount for the overflow bin
+     */
+    double at(DiscTypeID discTypeID, int bin) const;
+
+    /**
+     * @brief Values of disc types that the histogram doesn't have a row for are ignored
+     */
+    void fill(DiscTypeID discTypeID, double value);
+    void fill(std::span<const DiscTypeID> discTypeIDs, std::span<const double> values);
+
+    /**
+     * @brief Adds a full row of counts including underflow and overflow, as produced by binIndex()
+     */
+    void addCounts(DiscTypeID discTypeID, std::span<const std::uint64_t> counts);
+
+    void reset();
+    DenseHistogram& operator+=(const DenseHistogram& rhs);
+    DenseHistogram& operator/=(double divisor);
+    bool operator==(const DenseHistogram& rhs) const = default;
+
+    Histogram toHistogram() const;
+
+private:
+    double* getRow(DiscTypeID discTypeID);
+
+private:
+    std::vector<DiscTypeID> discTypeIDs_;
+    std::vector<int> rowIndices_; // Indexed by DiscTypeID, -1 if there is no row for the type
+    int binCount_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+    std::string label_;
+    std::vector<double> counts_;
+};
+
+} // namespace cell
+
+#endif /* EFC9E74D_9DA5_451B_BD50_8C5353542490_HPP */
@@ -5,6 +5,9 @@
 #include "PhysicalObject.hpp"
 #include "Vector2d.hpp"
 
+#include <atomic>
+#include <cstdint>
+
 namespace cell
 {
 
@@ -20,6 +23,7 @@ public:
      */
     explicit Disc(DiscTypeID discTypeID) noexcept
         : discTypeID_(discTypeID)
+        , id_(nextID_.fetch_add(1, std::memory_order_relaxed))
     {
     }
 
@@ -55,6 +59,15 @@ public:
         return destroyed_;
     }
 
+    /**
+     * @returns A unique ID that copies of the disc keep, i. e. a disc keeps its ID when it changes its compartment or
+     * its type in a reaction
+     */
+    std::uint64_t getID() const noexcept
+    {
+        return id_;
+    }
+
 private:
     /**
      * @brief Reactions of type A + B -> C require B to be removed (A can be changed to C). This flag
@@ -66,6 +79,9 @@ private:
      * @brief The properties of this disc (mass, radius, ...)
      */
     DiscTypeID discTypeID_;
+
+    std::uint64_t id_;
+    static inline std::atomic<std::uint64_t> nextID_ = 0;
 };
 
 } // namespace cell
@@ -0,0 +1,83 @@
+#include "DiscStatistics.hpp"
+#include "DenseHistogram.hpp"
+#include "Disc.hpp"
+#include "DiscType.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cell
+{
+
+DiscStatistics::DiscStatistics(const DiscTypeRegistry& discTypeRegistry, double vSigma)
+    : typeStatistics_(discTypeRegistry.getValues().size())
+    , vSigma_(vSigma)
+{
+    masses_.reserve(discTypeRegistry.getValues().size());
+    for (const auto& discType : discTypeRegistry.getValues())
+        masses_.push_back(discType.getMass());
+}
+
+void DiscStatistics::clear()
+{
+    std::fill(typeStatistics_.begin(), typeStatistics_.end(), TypeStatistics{});
+}
+
+void DiscStatistics::add(const Disc& disc)
+{
+    const auto discTypeID = disc.getTypeID();
+    const auto mass = masses_[discTypeID];
+    const auto& velocity = disc.getVelocity();
+    auto& statistics = typeStatistics_[discTypeID];
+
+    ++statistics.count;
+    statistics.kineticEnergy += disc.getKineticEnergy(mass);
+    statistics.momentum += disc.getMomentum(mass);
+
+    const double componentLimit = VelocityComponentRange * vSigma_;
+    ++statistics.vxCounts[DenseHistogram::binIndex(velocity.x, -componentLimit, componentLimit, HistogramBins)];
+    ++statistics.vyCounts[DenseHistogram::binIndex(velocity.y, -componentLimit, componentLimit, HistogramBins)];
+    ++statistics.vCounts[DenseHistogram::binIndex(mathutils::abs(velocity), 0, SpeedRange * vSigma_, HistogramBins)];
+}
+
+void DiscStatistics::add(const DiscStatistics& rhs)
+{
+    if (typeStatistics_.empty())
+    {
+        masses_ = rhs.masses_;
+        vSigma_ = rhs.vSigma_;
+    }
+
+    if (typeStatistics_.size() < rhs.typeStatistics_.size())
+        typeStatistics_.resize(rhs.typeStatistics_.size());
+
+    for (std::size_t i = 0; i < rhs.typeStatistics_.size(); ++i)
+    {
+        auto& lhsStatistics = typeStatistics_[i];
+        const auto& rhsStatistics = rhs.typeStatistics_[i];
+
+        lhsStatistics.count += rhsStatistics.count;
+        lhsStatistics.kineticEnergy += rhsStatistics.kineticEnergy;
+        lhsStatistics.momentum += rhsStatistics.momentum;
+
+        for (std::size_t bin = 0; bin < lhsStatistics.vxCounts.size(); ++bin)
+        {
+            lhsStatistics.vxCounts[bin] += rhsStatistics.vxCounts[bin];
+            lhsStatistics.vyCounts[bin] += rhsStatistics.vyCounts[bin];
+            lhsStatistics.vCounts[bin] += rhsStatistics.vCounts[bin];
+        }
+    }
+}
+
+double DiscStatistics::getVSigma() const
+{
+    return vSigma_;
+}
+
+const std::vector<DiscStatistics::TypeStatistics>& DiscStatistics::getTypeStatistics() const
+{
+    return typeStatistics_;
+}
+
+} // namespace cell
@@ -0,0 +1,71 @@
+#ifndef BE08AC24_6CA2_4613_98C2_A80261F168AF_HPP
+#define BE08AC24_6CA2_4613_98C2_A80261F168AF_HPP
+
+#include "Types.hpp"
+#include "Vector2d.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Per-type sums over a set of discs, stored in dense arrays indexed by DiscTypeID so that they can be filled
+ * while the discs are moved and added up cheaply afterwards
+ */
+class DiscStatistics
+{
+public:
+    static constexpr int HistogramBins = 20;
+
+    /**
+     * @brief Histogram ranges in multiples of the most probable speed: [-3, 3] for velocity components, [0, 4] for
+     * speed
+     */
+    static constexpr double VelocityComponentRange = 3;
+    static constexpr double SpeedRange = 4;
+
+    /**
+     * @brief The first and the last element count the values below and above the histogram range, see
+     * DenseHistogram::binIndex()
+     */
+    using HistogramCounts = std::array<std::uint64_t, HistogramBins + 2>;
+
+    struct TypeStatistics
+    {
+        std::uint64_t count = 0;
+        double kineticEnergy = 0;
+        Vector2d momentum;
+        HistogramCounts vxCounts{};
+        HistogramCounts vyCounts{};
+        HistogramCounts vCounts{};
+    };
+
+public:
+    DiscStatistics() = default;
+    DiscStatistics(const DiscTypeRegistry& discTypeRegistry, double vSigma);
+
+    void clear();
+    void add(const Disc& disc);
+
+    /**
+     * @brief Adds the sums of rhs, which must use the same vSigma. Default-constructed statistics take over the masses
+     * and vSigma of the first statistics added to them
+     */
+    void add(const DiscStatistics& rhs);
+
+    double getVSigma() const;
+    const std::vector<TypeStatistics>& getTypeStatistics() const;
+
+private:
+    std::vector<TypeStatistics> typeStatistics_;
+    std::vector<double> masses_;
+    double vSigma_ = 0;
+};
+
+} // namespace cell
+
+#endif /* BE08AC24_6CA2_4613_98C2_A80261F168AF_HPP */
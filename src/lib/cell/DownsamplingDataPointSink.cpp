@@ -0,0 +1,143 @@
+#include "DownsamplingDataPointSink.hpp"
+#include "ExceptionWithLocation.hpp"
+
+#include <algorithm>
+
+namespace cell
+{
+
+namespace
+{
+// Merges pairs of consecutive data points in the older half, the initial data point stays at the front
+void mergeOlderHalf(std::deque<DataPoint>& dataPoints)
+{
+    const auto pairCount = (dataPoints.size() - 1) / 4;
+    for (std::size_t i = 0; i < pairCount; ++i)
+    {
+        auto merged = dataPoints[1 + 2 * i];
+        merged.add(dataPoints[2 + 2 * i]);
+        merged.average(NormalizeCollisionCounts{false});
+        dataPoints[1 + i] = std::move(merged);
+    }
+
+    const auto mergedEnd = dataPoints.begin() + static_cast<std::ptrdiff_t>(1 + pairCount);
+    dataPoints.erase(mergedEnd, mergedEnd + static_cast<std::ptrdiff_t>(pairCount));
+}
+} // namespace
+
+DownsamplingDataPointSink::DownsamplingDataPointSink(const ch::nanoseconds& baseInterval, std::size_t levelCount,
+                                                     int factor, std::size_t maxDataPointsPerLevel)
+    : factor_(factor)
+    , maxDataPointsPerLevel_(maxDataPointsPerLevel)
+{
+    if (baseInterval <= ch::nanoseconds{0})
+        throw ExceptionWithLocation("Base interval must be positive");
+
+    if (levelCount == 0)
+        throw ExceptionWithLocation("There must be at least 1 level");
+
+    if (factor_ < 2)
+        throw ExceptionWithLocation("Downsampling factor must be at least 2");
+
+    if (maxDataPointsPerLevel_ < 5)
+        throw ExceptionWithLocation("Levels must be able to hold at least 5 data points");
+
+    levels_.resize(levelCount);
+    ch::nanoseconds interval = baseInterval;
+    for (auto& level : levels_)
+    {
+        level.interval = interval;
+        interval *= factor_;
+    }
+}
+
+void DownsamplingDataPointSink::add(const DataPoint& dataPoint)
+{
+    std::scoped_lock lock(mutex_);
+
+    // The initial data point doesn't span any time and is shown as-is on every level
+    if (dataPoint.getData().elapsedTime == ch::nanoseconds{0})
+    {
+        for (auto& level : levels_)
+            level.dataPoints.push_back(dataPoint);
+
+        return;
+    }
+
+    addToLevel(0, dataPoint);
+}
+
+void DownsamplingDataPointSink::clear()
+{
+    std::scoped_lock lock(mutex_);
+
+    for (auto& level : levels_)
+    {
+        level.dataPoints.clear();
+        level.pending.clear();
+        level.pendingCount = 0;
+    }
+}
+
+std::size_t DownsamplingDataPointSink::getLevelCount() const
+{
+    return levels_.size();
+}
+
+const ch::nanoseconds& DownsamplingDataPointSink::getLevelInterval(std::size_t level) const
+{
+    return levels_.at(level).interval;
+}
+
+std::size_t DownsamplingDataPointSink::getCoarsestLevelFor(const ch::nanoseconds& interval) const
+{
+    for (std::size_t level = levels_.size(); level-- > 0;)
+    {
+        if (interval >= levels_[level].interval && interval % levels_[level].interval == ch::nanoseconds{0})
+            return level;
+    }
+
+    return 0;
+}
+
+void DownsamplingDataPointSink::readLevel(std::size_t level,
+                                          const std::function<void(const std::deque<DataPoint>&)>& reader,
+                                          std::size_t maxDataPoints) const
+{
+    std::deque<DataPoint> dataPoints;
+    {
+        std::scoped_lock lock(mutex_);
+        const auto& levelDataPoints = levels_.at(level).dataPoints;
+        const auto count = std::min(maxDataPoints, levelDataPoints.size());
+        dataPoints.assign(levelDataPoints.end() - static_cast<std::ptrdiff_t>(count), levelDataPoints.end());
+    }
+
+    reader(dataPoints);
+}
+
+void DownsamplingDataPointSink::addToLevel(std::size_t level, const DataPoint& dataPoint)
+{
+    auto& currentLevel = levels_[level];
+    currentLevel.dataPoints.push_back(dataPoint);
+    if (currentLevel.dataPoints.size() >= maxDataPointsPerLevel_)
+        mergeOlderHalf(currentLevel.dataPoints);
+
+    if (level + 1 == levels_.size())
+        return;
+
+    // Copying the first data point of a bucket avoids having to initialize the histograms of the pending data point
+    if (currentLevel.pendingCount == 0)
+        currentLevel.pending = dataPoint;
+    else
+        currentLevel.pending.add(dataPoint);
+
+    if (++currentLevel.pendingCount < factor_)
+        return;
+
+    // Collision counts stay summed up, just like the recorder stores them
+    currentLevel.pending.average(NormalizeCollisionCounts{false});
+    addToLevel(level + 1, currentLevel.pending);
+    currentLevel.pendingCount = 0;
+}
+
+} // namespace cell
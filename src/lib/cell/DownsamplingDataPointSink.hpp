@@ -0,0 +1,78 @@
+#ifndef E10F32B7_3901_4666_BFFB_F71614B38958_HPP
+#define E10F32B7_3901_4666_BFFB_F71614B38958_HPP
+
+#include "DataPoint.hpp"
+#include "DataPointSink.hpp"
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Keeps the recorded history as a pyramid of pre-aggregated levels. Level 0 holds the data points as they
+ * arrive from the recorder, every further level averages `factor` consecutive points of the level below, i. e. with a
+ * storage interval of 10ms and 4 levels the buckets span 10ms, 100ms, 1s and 10s. Consumers that need the history at a
+ * coarse resolution can read the matching level instead of re-aggregating all data points.
+ *
+ * Every level starts with the initial data point (0 elapsed time). Once a level reaches `maxDataPointsPerLevel`, pairs
+ * of data points in its older half are merged, so that the old history gets coarser instead of growing without bound.
+ * Access is synchronized so that the levels can be read while the simulation thread keeps adding data points
+ */
+class DownsamplingDataPointSink : public DataPointSink
+{
+public:
+    /**
+     * @param baseInterval Storage interval of the recorder, the bucket size of level 0
+     * @param levelCount Number of levels including level 0
+     * @param factor How many buckets of a level are combined into one bucket of the next level
+     * @param maxDataPointsPerLevel Size at which the older half of a level is merged into half as many data points
+     */
+    DownsamplingDataPointSink(const ch::nanoseconds& baseInterval, std::size_t levelCount = 4, int factor = 10,
+                              std::size_t maxDataPointsPerLevel = 10000);
+
+    void add(const DataPoint& dataPoint) override;
+    void clear() override;
+
+    std::size_t getLevelCount() const;
+    const ch::nanoseconds& getLevelInterval(std::size_t level) const;
+
+    /**
+     * @returns The coarsest level whose bucket size evenly divides the given interval, 0 if there is none
+     */
+    std::size_t getCoarsestLevelFor(const ch::nanoseconds& interval) const;
+
+    /**
+     * @brief Calls the reader with a copy of the data points of the given level, so that adding data points doesn't
+     * wait for the reader
+     * @param maxDataPoints Only the newest this many data points are copied, readers that don't need the whole
+     * history shouldn't pay for copying it
+     */
+    void readLevel(std::size_t level, const std::function<void(const std::deque<DataPoint>&)>& reader,
+                   std::size_t maxDataPoints = std::numeric_limits<std::size_t>::max()) const;
+
+private:
+    struct Level
+    {
+        ch::nanoseconds interval;
+        std::deque<DataPoint> dataPoints;
+        DataPoint pending;
+        int pendingCount = 0;
+    };
+
+    void addToLevel(std::size_t level, const DataPoint& dataPoint);
+
+private:
+    std::vector<Level> levels_;
+    int factor_;
+    std::size_t maxDataPointsPerLevel_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cell
+
+#endif /* E10F32B7_3901_4666_BFFB_F71614B38958_HPP */
@@ -0,0 +1,90 @@
+#include "EquilibriumDetector.hpp"
+#include "ExceptionWithLocation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cell
+{
+
+EquilibriumDetector::EquilibriumDetector(std::vector<DiscTypeID> discTypeIDs, Params params)
+    : discTypeIDs_(std::move(discTypeIDs))
+    , params_(params)
+{
+    if (params_.windowSize < 2)
+        throw ExceptionWithLocation("Equilibrium detection needs windows of at least 2 data points");
+}
+
+bool EquilibriumDetector::add(const DataPoint::Data& data)
+{
+    if (isInEquilibrium_)
+        return false;
+
+    elapsedTime_ += data.elapsedTime;
+
+    std::vector<double> sample;
+    sample.reserve(discTypeIDs_.size() + 1);
+    for (const auto discTypeID : discTypeIDs_)
+    {
+        const auto count = data.discTypeCounts.find(discTypeID);
+        sample.push_back(count == data.discTypeCounts.end() ? 0.0 : count->second);
+    }
+
+    double kineticEnergy = 0;
+    for (const auto& [discTypeID, energy] : data.totalKineticEnergies)
+        kineticEnergy += energy;
+    sample.push_back(kineticEnergy);
+
+    samples_.push_back(std::move(sample));
+    if (samples_.size() > 2 * static_cast<std::size_t>(params_.windowSize))
+        samples_.pop_front();
+
+    isInEquilibrium_ = windowsMatch();
+
+    return isInEquilibrium_;
+}
+
+bool EquilibriumDetector::isInEquilibrium() const
+{
+    return isInEquilibrium_;
+}
+
+const ch::nanoseconds& EquilibriumDetector::getEquilibriumTime() const
+{
+    return elapsedTime_;
+}
+
+bool EquilibriumDetector::windowsMatch() const
+{
+    const auto windowSize = static_cast<std::size_t>(params_.windowSize);
+    if (samples_.size() < 2 * windowSize)
+        return false;
+
+    const auto n = static_cast<double>(windowSize);
+    for (std::size_t i = 0; i < samples_.front().size(); ++i)
+    {
+        double sums[2]{};
+        double squareSums[2]{};
+        for (std::size_t j = 0; j < samples_.size(); ++j)
+        {
+            const auto value = samples_[j][i];
+            sums[j / windowSize] += value;
+            squareSums[j / windowSize] += value * value;
+        }
+
+        const double means[2]{sums[0] / n, sums[1] / n};
+        const auto variance = [&](int window)
+        { return std::max(0.0, (squareSums[window] - n * means[window] * means[window]) / (n - 1)); };
+
+        const auto standardError = std::sqrt((variance(0) + variance(1)) / n);
+        const auto tolerance =
+            params_.relativeTolerance * std::abs(0.5 * (means[0] + means[1])) + params_.zScore * standardError;
+
+        if (std::abs(means[1] - means[0]) > tolerance)
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace cell
@@ -0,0 +1,62 @@
+#ifndef C9FEC5DC_1A55_4858_99CE_A50EB28334C1_HPP
+#define C9FEC5DC_1A55_4858_99CE_A50EB28334C1_HPP
+
+#include "DataPoint.hpp"
+#include "Types.hpp"
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace ch = std::chrono;
+
+namespace cell
+{
+
+/**
+ * @brief Watches the stream of recorded data points for the point where the disc type counts and the total kinetic
+ * energy stop drifting. The last 2 windows of `windowSize` data points are compared: Every quantity must have moved by
+ * at most `relativeTolerance` of its mean plus `zScore` standard errors of the difference between the window means, so
+ * noisy quantities aren't held to a tolerance they can't meet
+ */
+class EquilibriumDetector
+{
+public:
+    struct Params
+    {
+        int windowSize = 100;
+        double relativeTolerance = 0.01;
+        double zScore = 2;
+    };
+
+public:
+    EquilibriumDetector(std::vector<DiscTypeID> discTypeIDs, Params params);
+
+    /**
+     * @returns true if the equilibrium was detected with this data point. Once detected, it's never detected again
+     */
+    bool add(const DataPoint::Data& data);
+
+    bool isInEquilibrium() const;
+
+    /**
+     * @brief Simulation time covered by the data points up to the one the equilibrium was detected with
+     */
+    const ch::nanoseconds& getEquilibriumTime() const;
+
+private:
+    bool windowsMatch() const;
+
+private:
+    std::vector<DiscTypeID> discTypeIDs_;
+    Params params_;
+
+    // Disc type counts in the order of discTypeIDs_, followed by the total kinetic energy
+    std::deque<std::vector<double>> samples_;
+    ch::nanoseconds elapsedTime_{0};
+    bool isInEquilibrium_ = false;
+};
+
+} // namespace cell
+
+#endif /* C9FEC5DC_1A55_4858_99CE_A50EB28334C1_HPP */
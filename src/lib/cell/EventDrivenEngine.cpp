@@ -0,0 +1,394 @@
+#include "EventDrivenEngine.hpp"
+#include "CollisionHandler.hpp"
+#include "Disc.hpp"
+#include "Membrane.hpp"
+#include "ReactionEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace cell
+{
+
+namespace
+{
+// Epochs are planned with some headroom so that a disc getting slightly faster doesn't immediately end the epoch
+constexpr double SpeedHeadroom = 1.25;
+
+// Discs that are outside of their membrane by less than this (relative to the membrane radius) are treated as touching
+// it, which catches rounding errors after a collision
+constexpr double RelativeTolerance = 1e-9;
+} // namespace
+
+EventDrivenEngine::EventDrivenEngine(SimulationContext simulationContext)
+    : simulationContext_(std::move(simulationContext))
+    , collision_(1)
+{
+}
+
+void EventDrivenEngine::setParams(Params params)
+{
+    params_ = std::move(params);
+}
+
+void EventDrivenEngine::advance(double dt)
+{
+    const auto& discs = *params_.discs;
+    discStates_.resize(discs.size());
+    for (std::size_t i = 0; i < discs.size(); ++i)
+        discStates_[i] =
+            DiscState{.radius = simulationContext_.discTypeRegistry.getByID(discs[i].getTypeID()).getRadius()};
+
+    double time = 0;
+    while (time < dt)
+    {
+        startEpoch(time, dt);
+        time = epochEnd_;
+
+        while (!events_.empty())
+        {
+            std::pop_heap(events_.begin(), events_.end(), std::greater<>{});
+            const auto event = events_.back();
+            events_.pop_back();
+
+            if (!isValid(event))
+                continue;
+
+            processEvent(event, dt);
+
+            if (epochInvalidated_)
+            {
+                time = event.time;
+                break;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < discs.size(); ++i)
+    {
+        if (!discs[i].isMarkedDestroyed())
+            moveTo(i, dt);
+    }
+}
+
+void EventDrivenEngine::startEpoch(double time, double endTime)
+{
+    auto& discs = *params_.discs;
+    events_.clear();
+    epochInvalidated_ = false;
+
+    double maxSpeedSquared = 0;
+    double maxRadius = 0;
+    std::size_t discCount = 0;
+
+    for (std::size_t i = 0; i < discs.size(); ++i)
+    {
+        if (discs[i].isMarkedDestroyed())
+            continue;
+
+        moveTo(i, time);
+        maxSpeedSquared = std::max(maxSpeedSquared, discs[i].getVelocity() * discs[i].getVelocity());
+        maxRadius = std::max(maxRadius, discStates_[i].radius);
+        ++discCount;
+    }
+
+    epochEnd_ = endTime;
+    if (discCount == 0)
+        return;
+
+    // Cells should hold about 1 disc on average, but must be large enough that a disc can travel a bit within them
+    const double membraneRadius =
+        simulationContext_.membraneTypeRegistry.getByID(params_.containingMembrane->getTypeID()).getRadius();
+    cellSize_ = std::max(4 * maxRadius, 2 * membraneRadius / std::sqrt(static_cast<double>(discCount)));
+    maxSpeed_ = SpeedHeadroom * std::sqrt(maxSpeedSquared);
+
+    // Within an epoch, discs that start more than 1 cell apart can't meet
+    if (maxSpeed_ > 0)
+        epochEnd_ = std::min(endTime, time + (cellSize_ - 2 * maxRadius) / (2 * maxSpeed_));
+
+    buildGrid();
+
+    for (std::size_t i = 0; i < discs.size(); ++i)
+        predictEvents(i, time, true);
+}
+
+void EventDrivenEngine::buildGrid()
+{
+    const auto& discs = *params_.discs;
+    const double membraneRadius =
+        simulationContext_.membraneTypeRegistry.getByID(params_.containingMembrane->getTypeID()).getRadius();
+
+    gridOrigin_ = params_.containingMembrane->getPosition() - Vector2d{membraneRadius, membraneRadius};
+    gridSize_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(2 * membraneRadius / cellSize_)));
+
+    // Counting sort of the discs by cell
+    cellStarts_.assign(gridSize_ * gridSize_ + 1, 0);
+    discCells_.resize(discs.size());
+    for (std::size_t i = 0; i < discs.size(); ++i)
+    {
+        if (discs[i].isMarkedDestroyed())
+            continue;
+
+        discCells_[i] = getCellIndex(discs[i].getPosition());
+        ++cellStarts_[discCells_[i] + 1];
+    }
+
+    for (std::size_t cell = 1; cell < cellStarts_.size(); ++cell)
+        cellStarts_[cell] += cellStarts_[cell - 1];
+
+    cellDiscs_.resize(cellStarts_.back());
+    for (std::size_t i = 0; i < discs.size(); ++i)
+    {
+        if (!discs[i].isMarkedDestroyed())
+            cellDiscs_[cellStarts_[discCells_[i]]++] = i;
+    }
+
+    // Filling shifted every start to the start of the next cell
+    for (std::size_t cell = cellStarts_.size() - 1; cell > 0; --cell)
+        cellStarts_[cell] = cellStarts_[cell - 1];
+    cellStarts_[0] = 0;
+}
+
+void EventDrivenEngine::predictEvents(std::size_t i, double time, bool onlyHigherIndices)
+{
+    if ((*params_.discs)[i].isMarkedDestroyed())
+        return;
+
+    predictContainingMembraneEvent(i, time);
+    predictChildMembraneEvents(i, time);
+
+    const auto cellX = static_cast<long long>(discCells_[i] % gridSize_);
+    const auto cellY = static_cast<long long>(discCells_[i] / gridSize_);
+    const auto gridSize = static_cast<long long>(gridSize_);
+
+    for (long long y = std::max(0LL, cellY - 1); y <= std::min(gridSize - 1, cellY + 1); ++y)
+    {
+        for (long long x = std::max(0LL, cellX - 1); x <= std::min(gridSize - 1, cellX + 1); ++x)
+        {
+            const auto cell = static_cast<std::size_t>(y * gridSize + x);
+            for (std::size_t k = cellStarts_[cell]; k < cellStarts_[cell + 1]; ++k)
+            {
+                const auto j = cellDiscs_[k];
+                if (j == i || (onlyHigherIndices && j < i))
+                    continue;
+
+                predictDiscDiscEvent(i, j, time);
+            }
+        }
+    }
+}
+
+void EventDrivenEngine::predictDiscDiscEvent(std::size_t i, std::size_t j, double time)
+{
+    const auto& discs = *params_.discs;
+    if (discs[j].isMarkedDestroyed())
+        return;
+
+    const Vector2d dp = getPositionAt(j, time) - getPositionAt(i, time);
+    const Vector2d dv = discs[j].getVelocity() - discs[i].getVelocity();
+
+    // Solve |dp + dv * t| = r1 + r2 for the first contact, discs that move apart won't collide
+    const double b = dp * dv;
+    if (b >= 0)
+        return;
+
+    const double sigma = discStates_[i].radius + discStates_[j].radius;
+    const double c = dp * dp - sigma * sigma;
+
+    double collisionTime = time;
+    if (c > 0)
+    {
+        const double discriminant = b * b - (dv * dv) * c;
+        if (discriminant < 0)
+            return;
+
+        // Equivalent to (-b - sqrt(discriminant)) / |dv|^2, but without cancellation
+        collisionTime += c / (-b + std::sqrt(discriminant));
+    }
+
+    pushEvent(Event{.time = collisionTime,
+                    .disc = i,
+                    .partner = j,
+                    .discEventCount = discStates_[i].eventCount,
+                    .partnerEventCount = discStates_[j].eventCount,
+                    .type = EventType::DiscDisc});
+}
+
+void EventDrivenEngine::predictContainingMembraneEvent(std::size_t i, double time)
+{
+    const auto& disc = (*params_.discs)[i];
+    const auto& membrane = *params_.containingMembrane;
+    const auto& membraneType = simulationContext_.membraneTypeRegistry.getByID(membrane.getTypeID());
+
+    if (CollisionDetector::permeabilityAllowsPassing(membraneType.getPermeabilityFor(disc.getTypeID()),
+                                                     CollisionDetector::CollisionType::DiscContainingMembrane))
+        return;
+
+    // Solve |q + v * t| = R - r, the disc is inside, so there is exactly 1 positive solution
+    const Vector2d q = getPositionAt(i, time) - membrane.getPosition();
+    const Vector2d& v = disc.getVelocity();
+    const double rho = membraneType.getRadius() - discStates_[i].radius;
+    const double vv = v * v;
+    double c = q * q - rho * rho;
+
+    // Discs that are still partially outside (i. e. didn't make it through the membrane yet) are left alone
+    if (vv == 0 || c > 2 * rho * rho * RelativeTolerance)
+        return;
+
+    c = std::min(c, 0.0);
+    const double b = q * v;
+
+    pushEvent(Event{.time = time + (-b + std::sqrt(b * b - vv * c)) / vv,
+                    .disc = i,
+                    .discEventCount = discStates_[i].eventCount,
+                    .type = EventType::DiscContainingMembrane});
+}
+
+void EventDrivenEngine::predictChildMembraneEvents(std::size_t i, double time)
+{
+    const auto& disc = (*params_.discs)[i];
+    const auto& membranes = *params_.membranes;
+    const Vector2d position = getPositionAt(i, time);
+    const Vector2d& v = disc.getVelocity();
+
+    for (std::size_t k = 0; k < membranes.size(); ++k)
+    {
+        const auto& membraneType = simulationContext_.membraneTypeRegistry.getByID(membranes[k].getTypeID());
+        if (CollisionDetector::permeabilityAllowsPassing(membraneType.getPermeabilityFor(disc.getTypeID()),
+                                                         CollisionDetector::CollisionType::DiscChildMembrane))
+            continue;
+
+        // Same as for 2 discs, just that the membrane doesn't move
+        const Vector2d q = position - membranes[k].getPosition();
+        const double b = q * v;
+        if (b >= 0)
+            continue;
+
+        const double rho = membraneType.getRadius() + discStates_[i].radius;
+        double c = q * q - rho * rho;
+
+        // Discs that are still partially inside (i. e. didn't make it out of the child compartment yet) are left alone
+        if (c < -2 * rho * rho * RelativeTolerance)
+            continue;
+
+        c = std::max(c, 0.0);
+        const double discriminant = b * b - (v * v) * c;
+        if (discriminant < 0)
+            continue;
+
+        pushEvent(Event{.time = time + c / (-b + std::sqrt(discriminant)),
+                        .disc = i,
+                        .partner = k,
+                        .discEventCount = discStates_[i].eventCount,
+                        .type = EventType::DiscChildMembrane});
+    }
+}
+
+void EventDrivenEngine::pushEvent(const Event& event)
+{
+    // Events after the epoch might involve discs that aren't in the neighboring cells anymore, they're predicted again
+    if (event.time > epochEnd_)
+        return;
+
+    events_.push_back(event);
+    std::push_heap(events_.begin(), events_.end(), std::greater<>{});
+}
+
+bool EventDrivenEngine::isValid(const Event& event) const
+{
+    const auto& discs = *params_.discs;
+    if (discs[event.disc].isMarkedDestroyed() || discStates_[event.disc].eventCount != event.discEventCount)
+        return false;
+
+    if (event.type != EventType::DiscDisc)
+        return true;
+
+    return !discs[event.partner].isMarkedDestroyed() &&
+           discStates_[event.partner].eventCount == event.partnerEventCount;
+}
+
+void EventDrivenEngine::processEvent(const Event& event, double endTime)
+{
+    auto& discs = *params_.discs;
+    auto& disc = discs[event.disc];
+    moveTo(event.disc, event.time);
+    ++discStates_[event.disc].eventCount;
+
+    if (event.type == EventType::DiscDisc)
+    {
+        auto& otherDisc = discs[event.partner];
+        moveTo(event.partner, event.time);
+        ++discStates_[event.partner].eventCount;
+
+        collision_[0] = CollisionDetector::Collision{
+            .disc = &disc, .otherDisc = &otherDisc, .type = CollisionDetector::CollisionType::DiscDisc};
+        params_.collisionDetector->countCollision(disc, otherDisc);
+        simulationContext_.collisionHandler.resolveCollisions(collision_);
+
+        auto& newDiscs = *params_.newDiscs;
+        const auto newDiscCount = newDiscs.size();
+        simulationContext_.reactionEngine.applyBimolecularReactions(collision_, newDiscs);
+
+        // Products only take part in collisions from the next step on
+        for (std::size_t k = newDiscCount; k < newDiscs.size(); ++k)
+            newDiscs[k].move(newDiscs[k].getVelocity() * (endTime - event.time));
+    }
+    else
+    {
+        const bool isContainingMembrane = event.type == EventType::DiscContainingMembrane;
+        collision_[0] = CollisionDetector::Collision{
+            .disc = &disc,
+            .membrane = isContainingMembrane ? params_.containingMembrane : &(*params_.membranes)[event.partner],
+            .type = isContainingMembrane ? CollisionDetector::CollisionType::DiscContainingMembrane
+                                         : CollisionDetector::CollisionType::DiscChildMembrane};
+        simulationContext_.collisionHandler.resolveCollisions(collision_);
+    }
+
+    if (exceedsMaxSpeed(event.disc) || (event.type == EventType::DiscDisc && exceedsMaxSpeed(event.partner)))
+    {
+        epochInvalidated_ = true;
+        return;
+    }
+
+    predictEvents(event.disc, event.time, false);
+    if (event.type == EventType::DiscDisc)
+        predictEvents(event.partner, event.time, false);
+}
+
+void EventDrivenEngine::moveTo(std::size_t i, double time)
+{
+    auto& disc = (*params_.discs)[i];
+    disc.move(disc.getVelocity() * (time - discStates_[i].time));
+    discStates_[i].time = time;
+}
+
+bool EventDrivenEngine::exceedsMaxSpeed(std::size_t i) const
+{
+    const auto& disc = (*params_.discs)[i];
+
+    return !disc.isMarkedDestroyed() && disc.getVelocity() * disc.getVelocity() > maxSpeed_ * maxSpeed_;
+}
+
+Vector2d EventDrivenEngine::getPositionAt(std::size_t i, double time) const
+{
+    const auto& disc = (*params_.discs)[i];
+
+    return disc.getPosition() + disc.getVelocity() * (time - discStates_[i].time);
+}
+
+std::size_t EventDrivenEngine::getCellIndex(const Vector2d& position) const
+{
+    // Clamping keeps discs that are partially outside of the membrane in the border cells
+    const auto toCell = [&](double coordinate)
+    {
+        const auto cell = static_cast<long long>(std::floor(coordinate / cellSize_));
+        return static_cast<std::size_t>(std::clamp(cell, 0LL, static_cast<long long>(gridSize_) - 1));
+    };
+
+    const Vector2d relativePosition = position - gridOrigin_;
+
+    return toCell(relativePosition.y) * gridSize_ + toCell(relativePosition.x);
+}
+
+} // namespace cell
@@ -0,0 +1,113 @@
+#ifndef B279847E_F6B3_4BA0_95E1_BC3D35509090_HPP
+#define B279847E_F6B3_4BA0_95E1_BC3D35509090_HPP
+
+#include "CollisionDetector.hpp"
+#include "SimulationContext.hpp"
+#include "Vector2d.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace cell
+{
+
+class Disc;
+class Membrane;
+
+/**
+ * @brief Hard-disc engine for a single compartment. Instead of moving all discs by a whole step and resolving overlaps
+ * afterwards, it computes the exact times at which discs hit each other or a membrane and processes these events in
+ * chronological order. Discs are only moved when they take part in an event (or at the end of the step), so a step
+ * costs about as much as the number of collisions in it, no matter how long it is.
+ *
+ * Neighbors are found with a uniform grid. The step is divided into epochs that are short enough for no disc to reach
+ * a disc outside of the neighboring grid cells, so the grid only needs to be rebuilt once per epoch
+ */
+class EventDrivenEngine
+{
+public:
+    struct Params
+    {
+        std::vector<Disc>* discs = nullptr;
+        std::vector<Membrane>* membranes = nullptr;
+        Membrane* containingMembrane = nullptr;
+        std::vector<Disc>* newDiscs = nullptr;
+        CollisionDetector* collisionDetector = nullptr; // Counts the collisions
+    };
+
+    explicit EventDrivenEngine(SimulationContext simulationContext);
+    void setParams(Params params);
+
+    /**
+     * @brief Moves all discs by dt, resolving every collision with a disc or a membrane on the way. Products of
+     * bimolecular reactions are appended to the new discs, already moved to the end of the step
+     */
+    void advance(double dt);
+
+private:
+    enum class EventType
+    {
+        DiscDisc,
+        DiscContainingMembrane,
+        DiscChildMembrane
+    };
+
+    struct Event
+    {
+        double time = 0;
+        std::size_t disc = 0;
+        std::size_t partner = 0; // Index of the other disc or of the child membrane
+        std::uint32_t discEventCount = 0;
+        std::uint32_t partnerEventCount = 0;
+        EventType type = EventType::DiscDisc;
+
+        bool operator>(const Event& other) const
+        {
+            return time > other.time;
+        }
+    };
+
+    struct DiscState
+    {
+        double time = 0; // Point in time the position of the disc refers to
+        double radius = 0;
+        std::uint32_t eventCount = 0; // Events predicted before the last collision of the disc are outdated
+    };
+
+    void startEpoch(double time, double endTime);
+    void buildGrid();
+    void predictEvents(std::size_t i, double time, bool onlyHigherIndices);
+    void predictDiscDiscEvent(std::size_t i, std::size_t j, double time);
+    void predictContainingMembraneEvent(std::size_t i, double time);
+    void predictChildMembraneEvents(std::size_t i, double time);
+    void pushEvent(const Event& event);
+    bool isValid(const Event& event) const;
+    void processEvent(const Event& event, double endTime);
+    void moveTo(std::size_t i, double time);
+    bool exceedsMaxSpeed(std::size_t i) const;
+    Vector2d getPositionAt(std::size_t i, double time) const;
+    std::size_t getCellIndex(const Vector2d& position) const;
+
+private:
+    SimulationContext simulationContext_;
+    Params params_;
+
+    std::vector<DiscState> discStates_;
+    std::vector<Event> events_; // Min-heap by time
+    std::vector<CollisionDetector::Collision> collision_;
+
+    Vector2d gridOrigin_;
+    double cellSize_ = 0;
+    std::size_t gridSize_ = 0; // Cells per axis
+    std::vector<std::size_t> cellStarts_;
+    std::vector<std::size_t> cellDiscs_;
+    std::vector<std::size_t> discCells_;
+
+    double epochEnd_ = 0;
+    double maxSpeed_ = 0; // Upper bound for the speed of all discs that the current epoch was planned with
+    bool epochInvalidated_ = false;
+};
+
+} // namespace cell
+
+#endif /* B279847E_F6B3_4BA0_95E1_BC3D35509090_HPP */
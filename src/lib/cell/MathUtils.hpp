@@ -8,6 +8,7 @@
 #include "Types.hpp"
 #include "Vector2d.hpp"
 
+#include <cstdint>
 #include <ostream>
 #include <random>
 #include <unordered_map>
@@ -71,12 +72,40 @@ inline double calculateOverlap(const Vector2d& r, double R1, double R2) noexcept
     return R1 + R2 - distance;
 }
 
+/**
+ * @brief The generators behind getRandomNumber() and getRandomInt(), one per thread
+ */
+inline std::mt19937& getRandomNumberGenerator() noexcept
+{
+    static thread_local std::mt19937 gen{std::random_device{}()};
+
+    return gen;
+}
+
+inline std::minstd_rand& getFastRandomNumberGenerator() noexcept
+{
+    static thread_local std::minstd_rand rng{std::random_device{}()};
+
+    return rng;
+}
+
+/**
+ * @brief Seeds the random number generators of the calling thread. A simulation that only uses that thread then
+ * produces the same results for the same seed
+ */
+inline void seedRandomNumberGenerators(std::uint64_t seed)
+{
+    std::seed_seq seedSequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+    getRandomNumberGenerator().seed(seedSequence);
+    getFastRandomNumberGenerator().seed(getRandomNumberGenerator()());
+}
+
 /**
  * @brief Returns a number in the given range
  */
 template <typename T> T getRandomNumber(std::type_identity_t<T> low, std::type_identity_t<T> high) noexcept
 {
-    static thread_local std::mt19937 gen{std::random_device{}()};
+    auto& gen = getRandomNumberGenerator();
     if constexpr (std::is_integral_v<T>)
     {
         std::uniform_int_distribution<T> dist(low, high);
@@ -91,9 +120,7 @@ template <typename T> T getRandomNumber(std::type_identity_t<T> low, std::type_i
 
 inline unsigned int getRandomInt() noexcept
 {
-    static thread_local std::minstd_rand rng{std::random_device{}()};
-
-    return rng();
+    return getFastRandomNumberGenerator()();
 }
 
 /**
@@ -20,4 +20,12 @@ MembraneType::Permeability MembraneType::getPermeabilityFor(const DiscTypeID& di
     return iter->second;
 }
 
+void MembraneType::setPermeabilityFor(const DiscTypeID& discTypeID, Permeability permeability)
+{
+    if (permeability == Permeability::None)
+        permeabilityMap_.erase(discTypeID);
+    else
+        permeabilityMap_[discTypeID] = permeability;
+}
+
 } // namespace cell
\ No newline at end of file
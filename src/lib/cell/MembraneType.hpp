@@ -29,6 +29,7 @@ public:
     MembraneType& operator=(MembraneType&&) = default;
 
     Permeability getPermeabilityFor(const DiscTypeID& discTypeID) const;
+    void setPermeabilityFor(const DiscTypeID& discTypeID, Permeability permeability);
 
     const std::string& getName() const noexcept
     {
@@ -0,0 +1,222 @@
+#include "PoissonDiscSampler.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace cell
+{
+
+namespace
+{
+// Random points tried in the whole container when no placed disc has room left next to it
+constexpr int SeedAttempts = 100;
+} // namespace
+
+PoissonDiscSampler::PoissonDiscSampler(Params params)
+    : params_(std::move(params))
+    , generator_(std::random_device{}())
+{
+    const auto& container = params_.container;
+    cellSize_ = 2 * params_.maxDiscRadius + params_.gap;
+    origin_ = container.center - Vector2d{container.radius, container.radius};
+    gridSize_ = std::max(1, static_cast<int>(std::ceil(2 * container.radius / cellSize_)));
+
+    const auto cellCount = static_cast<std::size_t>(gridSize_) * static_cast<std::size_t>(gridSize_);
+    cellDiscs_.resize(cellCount);
+    cellObstacles_.resize(cellCount);
+
+    // A disc with its center in a cell can only overlap obstacles that reach into the cell by less than its radius
+    for (std::size_t i = 0; i < params_.obstacles.size(); ++i)
+    {
+        const auto& obstacle = params_.obstacles[i];
+        const auto reach = obstacle.radius + params_.maxDiscRadius;
+        const auto cellRange = [&](double min, double max, double origin)
+        {
+            const auto toCell = [&](double x)
+            { return static_cast<int>(std::clamp(std::floor((x - origin) / cellSize_), 0.0, gridSize_ - 1.0)); };
+
+            return std::pair{toCell(min), toCell(max)};
+        };
+
+        const auto [xBegin, xEnd] = cellRange(obstacle.center.x - reach, obstacle.center.x + reach, origin_.x);
+        const auto [yBegin, yEnd] = cellRange(obstacle.center.y - reach, obstacle.center.y + reach, origin_.y);
+        for (int y = yBegin; y <= yEnd; ++y)
+        {
+            for (int x = xBegin; x <= xEnd; ++x)
+                cellObstacles_[static_cast<std::size_t>(y * gridSize_ + x)].push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+std::vector<Vector2d> PoissonDiscSampler::sample(const std::vector<double>& radii,
+                                                 std::vector<std::size_t>& placedDiscs)
+{
+    positions_.clear();
+    radii_.clear();
+    placedDiscs.clear();
+    for (auto& discs : cellDiscs_)
+        discs.clear();
+
+    // A disc surrounded for large discs may still have room for small ones, so each radius has its own active discs
+    std::vector<double> radiusClasses = radii;
+    std::sort(radiusClasses.begin(), radiusClasses.end());
+    radiusClasses.erase(std::unique(radiusClasses.begin(), radiusClasses.end()), radiusClasses.end());
+    std::vector<std::vector<std::size_t>> activeDiscs(radiusClasses.size());
+
+    // Placing more discs only takes away room, so once a radius didn't fit anywhere, it won't later on either
+    std::vector<bool> radiusClassIsFull(radiusClasses.size(), false);
+
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    for (std::size_t disc = 0; disc < radii.size(); ++disc)
+    {
+        const auto radius = radii[disc];
+        const auto radiusClass = static_cast<std::size_t>(
+            std::lower_bound(radiusClasses.begin(), radiusClasses.end(), radius) - radiusClasses.begin());
+        if (radiusClassIsFull[radiusClass])
+            continue;
+
+        auto& active = activeDiscs[radiusClass];
+        Vector2d position;
+        bool placed = false;
+
+        while (!active.empty() && !placed)
+        {
+            const auto activeIndex = std::uniform_int_distribution<std::size_t>(0, active.size() - 1)(generator_);
+            const auto center = positions_[active[activeIndex]];
+            const auto minDistance = radii_[active[activeIndex]] + radius + params_.gap;
+
+            for (int i = 0; i < params_.candidatesPerDisc && !placed; ++i)
+            {
+                const auto distance = minDistance * (1 + unit(generator_));
+                const auto angle = 2 * std::numbers::pi * unit(generator_);
+                position = center + Vector2d{distance * std::cos(angle), distance * std::sin(angle)};
+                placed = isValid(position, radius, positions_.size());
+            }
+
+            if (!placed)
+            {
+                active[activeIndex] = active.back();
+                active.pop_back();
+            }
+        }
+
+        if (!placed && !seed(radius, position))
+        {
+            radiusClassIsFull[radiusClass] = true;
+            continue;
+        }
+
+        for (auto& discs : activeDiscs)
+            discs.push_back(positions_.size());
+
+        placedDiscs.push_back(disc);
+        positions_.push_back(position);
+        radii_.push_back(radius);
+        insert(positions_.size() - 1, position);
+    }
+
+    return positions_;
+}
+
+void PoissonDiscSampler::relax(std::vector<Vector2d>& positions, const std::vector<double>& radii, int sweeps)
+{
+    positions_ = positions;
+    radii_.assign(radii.begin(), radii.begin() + static_cast<std::ptrdiff_t>(positions.size()));
+    for (auto& discs : cellDiscs_)
+        discs.clear();
+    for (std::size_t i = 0; i < positions_.size(); ++i)
+        insert(i, positions_[i]);
+
+    std::uniform_real_distribution<double> unit(-1, 1);
+    for (int sweep = 0; sweep < sweeps; ++sweep)
+    {
+        for (std::size_t i = 0; i < positions_.size(); ++i)
+        {
+            // Moves of about the size of the gaps between discs are accepted often enough to make progress
+            const auto maxOffset = params_.gap + 0.5 * radii_[i];
+            const auto position = positions_[i] + maxOffset * Vector2d{unit(generator_), unit(generator_)};
+            if (!isValid(position, radii_[i], i))
+                continue;
+
+            erase(i, positions_[i]);
+            positions_[i] = position;
+            insert(i, position);
+        }
+    }
+
+    positions = positions_;
+}
+
+bool PoissonDiscSampler::isValid(const Vector2d& position, double radius, std::size_t ignoredDisc) const
+{
+    const auto& container = params_.container;
+    if (!mathutils::circleIsFullyContainedByCircle(position, radius, container.center, container.radius))
+        return false;
+
+    for (const auto obstacleIndex : cellObstacles_[getCellIndex(position)])
+    {
+        const auto& obstacle = params_.obstacles[obstacleIndex];
+        if (mathutils::circlesOverlap(position, radius, obstacle.center, obstacle.radius))
+            return false;
+    }
+
+    const auto cellX = static_cast<int>((position.x - origin_.x) / cellSize_);
+    const auto cellY = static_cast<int>((position.y - origin_.y) / cellSize_);
+    for (int y = std::max(0, cellY - 1); y <= std::min(gridSize_ - 1, cellY + 1); ++y)
+    {
+        for (int x = std::max(0, cellX - 1); x <= std::min(gridSize_ - 1, cellX + 1); ++x)
+        {
+            for (const auto disc : cellDiscs_[static_cast<std::size_t>(y * gridSize_ + x)])
+            {
+                if (disc == ignoredDisc)
+                    continue;
+
+                const auto diff = position - positions_[disc];
+                const auto minDistance = radius + radii_[disc] + params_.gap;
+                if (diff.x * diff.x + diff.y * diff.y < minDistance * minDistance)
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+std::size_t PoissonDiscSampler::getCellIndex(const Vector2d& position) const
+{
+    const auto x = std::clamp(static_cast<int>((position.x - origin_.x) / cellSize_), 0, gridSize_ - 1);
+    const auto y = std::clamp(static_cast<int>((position.y - origin_.y) / cellSize_), 0, gridSize_ - 1);
+
+    return static_cast<std::size_t>(y * gridSize_ + x);
+}
+
+void PoissonDiscSampler::insert(std::size_t disc, const Vector2d& position)
+{
+    cellDiscs_[getCellIndex(position)].push_back(static_cast<std::uint32_t>(disc));
+}
+
+void PoissonDiscSampler::erase(std::size_t disc, const Vector2d& position)
+{
+    auto& discs = cellDiscs_[getCellIndex(position)];
+    discs.erase(std::find(discs.begin(), discs.end(), static_cast<std::uint32_t>(disc)));
+}
+
+bool PoissonDiscSampler::seed(double radius, Vector2d& position)
+{
+    const auto& container = params_.container;
+    std::uniform_real_distribution<double> offset(-container.radius, container.radius);
+
+    for (int i = 0; i < SeedAttempts; ++i)
+    {
+        position = container.center + Vector2d{offset(generator_), offset(generator_)};
+        if (isValid(position, radius, positions_.size()))
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace cell
@@ -0,0 +1,85 @@
+#ifndef E8C1E114_8602_4ABB_83D5_58065AB91C92_HPP
+#define E8C1E114_8602_4ABB_83D5_58065AB91C92_HPP
+
+#include "Vector2d.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Places discs of different radii randomly inside a circle and outside of a set of circular obstacles, with at
+ * least `gap` between any 2 discs (Bridson's Poisson-disc sampling with per-disc distances). Unlike a grid spaced for
+ * the largest disc, small discs are packed according to their own size, and the result has no lattice structure that
+ * the simulation first needs to melt.
+ *
+ * Neighbors and obstacles are looked up in a uniform grid with cells large enough to hold the largest disc pair
+ */
+class PoissonDiscSampler
+{
+public:
+    struct Circle
+    {
+        Vector2d center;
+        double radius = 0;
+    };
+
+    struct Params
+    {
+        Circle container;
+        std::vector<Circle> obstacles;
+        double maxDiscRadius = 0;
+        double gap = 1;
+
+        /**
+         * @brief How often to try placing a new disc next to an existing one before that one is considered surrounded
+         * for discs of the new one's radius
+         */
+        int candidatesPerDisc = 30;
+    };
+
+public:
+    explicit PoissonDiscSampler(Params params);
+
+    /**
+     * @brief Places discs with the given radii, in the given order. A disc that doesn't fit is skipped, smaller ones
+     * after it are still placed
+     * @param placedDiscs Set to the indices in `radii` of the discs that could be placed
+     * @returns The positions of the placed discs, in the order of `placedDiscs`
+     */
+    std::vector<Vector2d> sample(const std::vector<double>& radii, std::vector<std::size_t>& placedDiscs);
+
+    /**
+     * @brief Moves every disc by a random offset in a few sweeps, rejecting moves that would make discs overlap or
+     * leave the valid area (hard-disc Monte Carlo). Smooths the structure of densely packed regions
+     */
+    void relax(std::vector<Vector2d>& positions, const std::vector<double>& radii, int sweeps);
+
+private:
+    bool isValid(const Vector2d& position, double radius, std::size_t ignoredDisc) const;
+    std::size_t getCellIndex(const Vector2d& position) const;
+    void insert(std::size_t disc, const Vector2d& position);
+    void erase(std::size_t disc, const Vector2d& position);
+    bool seed(double radius, Vector2d& position);
+
+private:
+    Params params_;
+    std::mt19937 generator_;
+
+    Vector2d origin_;
+    double cellSize_ = 0;
+    int gridSize_ = 0;
+    std::vector<std::vector<std::uint32_t>> cellDiscs_;
+    std::vector<std::vector<std::uint32_t>> cellObstacles_;
+
+    // Of the discs placed so far
+    std::vector<Vector2d> positions_;
+    std::vector<double> radii_;
+};
+
+} // namespace cell
+
+#endif /* E8C1E114_8602_4ABB_83D5_58065AB91C92_HPP */
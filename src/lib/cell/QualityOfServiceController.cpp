@@ -0,0 +1,83 @@
+#include "QualityOfServiceController.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace cell
+{
+
+namespace
+{
+// Running slightly slower than the target is measurement noise rather than lag
+constexpr double LagThreshold = 0.95;
+
+// Going back up a level doubles at most one lever, so the work per period must fit into the budget twice with margin
+constexpr double SpareLoadThreshold = 0.4;
+} // namespace
+
+QualityOfServiceController::QualityOfServiceController(const config::QualityOfService& limits)
+    : limits_(limits)
+{
+    while (makeFidelityLevel(maxLevel_ + 1).level > maxLevel_)
+        ++maxLevel_;
+}
+
+bool QualityOfServiceController::update(double targetScale, double actualScale, double load)
+{
+    int level = fidelityLevel_.level;
+    if (actualScale < LagThreshold * targetScale)
+        level = std::min(level + 1, maxLevel_);
+    else if (load < SpareLoadThreshold)
+        level = std::max(level - 1, 0);
+
+    if (level == fidelityLevel_.level)
+        return false;
+
+    fidelityLevel_ = makeFidelityLevel(level);
+
+    return true;
+}
+
+const QualityOfServiceController::FidelityLevel& QualityOfServiceController::getFidelityLevel() const
+{
+    return fidelityLevel_;
+}
+
+int QualityOfServiceController::getMaxLevel() const
+{
+    return maxLevel_;
+}
+
+QualityOfServiceController::FidelityLevel QualityOfServiceController::makeFidelityLevel(int level) const
+{
+    FidelityLevel fidelityLevel;
+
+    // Stops early if all levers reached their limits, the returned level is then lower than the requested one
+    while (fidelityLevel.level < level)
+    {
+        if (2 * fidelityLevel.frameIntervalFactor <= limits_.maxFrameIntervalFactor)
+            fidelityLevel.frameIntervalFactor *= 2;
+        else if (2 * fidelityLevel.recordingStride <= limits_.maxRecordingStride)
+            fidelityLevel.recordingStride *= 2;
+        else if (2 * fidelityLevel.timeStepFactor <= limits_.maxTimeStepFactor)
+            fidelityLevel.timeStepFactor *= 2;
+        else
+            break;
+
+        ++fidelityLevel.level;
+    }
+
+    return fidelityLevel;
+}
+
+std::string toString(const QualityOfServiceController::FidelityLevel& fidelityLevel)
+{
+    std::stringstream stream;
+    stream << "fidelity level " << fidelityLevel.level << " (frame interval x" << fidelityLevel.frameIntervalFactor
+           << ", recording every " << fidelityLevel.recordingStride << " updates, time step x"
+           << fidelityLevel.timeStepFactor << ")";
+
+    return stream.str();
+}
+
+} // namespace cell
@@ -0,0 +1,55 @@
+#ifndef A454D03C_CEEE_4FF1_B3BF_ACA436EA5A88_HPP
+#define A454D03C_CEEE_4FF1_B3BF_ACA436EA5A88_HPP
+
+#include "SimulationConfig.hpp"
+
+#include <string>
+
+namespace cell
+{
+
+/**
+ * @brief Decides once per measurement period how much fidelity a paced simulation gives up to keep up with its target
+ * scale. Level 0 is full fidelity, every further level doubles one lever within the limits of the config
+ */
+class QualityOfServiceController
+{
+public:
+    struct FidelityLevel
+    {
+        int level = 0;
+        int frameIntervalFactor = 1;
+        int recordingStride = 1;
+        double timeStepFactor = 1;
+
+        bool operator==(const FidelityLevel&) const = default;
+    };
+
+public:
+    explicit QualityOfServiceController(const config::QualityOfService& limits);
+
+    /**
+     * @brief Lowers the fidelity by one level if the simulation ran slower than the target scale, raises it by one
+     * level if the simulation would most likely still keep up with it
+     * @param load Fraction of the real time of the period that was spent working instead of waiting
+     * @returns true if the level changed
+     */
+    bool update(double targetScale, double actualScale, double load);
+
+    const FidelityLevel& getFidelityLevel() const;
+    int getMaxLevel() const;
+
+private:
+    FidelityLevel makeFidelityLevel(int level) const;
+
+private:
+    config::QualityOfService limits_;
+    FidelityLevel fidelityLevel_;
+    int maxLevel_ = 0;
+};
+
+std::string toString(const QualityOfServiceController::FidelityLevel& fidelityLevel);
+
+} // namespace cell
+
+#endif /* A454D03C_CEEE_4FF1_B3BF_ACA436EA5A88_HPP */
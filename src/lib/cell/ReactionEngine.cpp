@@ -11,8 +11,8 @@ namespace cell
 
 ReactionEngine::ReactionEngine(const DiscTypeRegistry& discTypeRegistry, const ReactionTable& reactionTable)
     : discTypeRegistry_(discTypeRegistry)
+    , active_(compile(reactionTable))
 {
-    combineReactionsIntoSingleMaps(reactionTable);
 }
 
 Disc ReactionEngine::transformationReaction(Disc* educt, DiscTypeID productID) const
@@ -188,43 +188,67 @@ void ReactionEngine::applyBimolecularReactions(const std::vector<CollisionDetect
     }
 }
 
+void ReactionEngine::setReactions(const ReactionTable& reactionTable)
+{
+    pending_.store(compile(reactionTable));
+}
+
+void ReactionEngine::activatePendingReactions() const
+{
+    if (auto pending = pending_.exchange(nullptr))
+        active_ = std::move(pending);
+}
+
+std::shared_ptr<const ReactionEngine::CompiledReactions> ReactionEngine::getActiveReactions() const
+{
+    return active_;
+}
+
 const Reaction* ReactionEngine::selectUnimolecularReaction(const DiscTypeID& key, double dt) const
 {
     return selectReaction(
-        unimolecularReactions_, key, [&](const Reaction& reaction)
+        active_->unimolecularReactions, key, [&](const Reaction& reaction)
         { return mathutils::getRandomNumber<double>(0, 1) <= 1 - std::pow(1 - reaction.getProbability(), dt); });
 }
 
 const Reaction* ReactionEngine::selectBimolecularReaction(const std::pair<DiscTypeID, DiscTypeID>& key) const
 {
-    return selectReaction(bimolecularReactions_, key, [](const Reaction& reaction)
+    return selectReaction(active_->bimolecularReactions, key, [](const Reaction& reaction)
                           { return mathutils::getRandomNumber<double>(0, 1) <= reaction.getProbability(); });
 }
 
-void ReactionEngine::combineReactionsIntoSingleMaps(const ReactionTable& reactionTable)
+std::shared_ptr<const ReactionEngine::CompiledReactions> ReactionEngine::compile(const ReactionTable& reactionTable)
 {
+    auto compiledReactions = std::make_shared<CompiledReactions>();
+    compiledReactions->version = ++latestVersion_;
+    auto& unimolecularReactions = compiledReactions->unimolecularReactions;
+    auto& bimolecularReactions = compiledReactions->bimolecularReactions;
+
     for (const auto& table : {reactionTable.getTransformations(), reactionTable.getDecompositions()})
     {
         for (const auto& [educt, reactions] : table)
-            unimolecularReactions_[educt].insert(unimolecularReactions_[educt].end(), reactions.begin(),
-                                                 reactions.end());
+            unimolecularReactions[educt].insert(unimolecularReactions[educt].end(), reactions.begin(),
+                                                reactions.end());
     }
 
     for (const auto& table : {reactionTable.getCombinations(), reactionTable.getExchanges()})
     {
         for (const auto& [educts, reactions] : table)
-            bimolecularReactions_[educts].insert(bimolecularReactions_[educts].end(), reactions.begin(),
-                                                 reactions.end());
+            bimolecularReactions[educts].insert(bimolecularReactions[educts].end(), reactions.begin(),
+                                                reactions.end());
     }
 
-    // Random shuffle all reactions to avoid a bias
-    std::minstd_rand rng{std::random_device{}()};
+    // Random shuffle all reactions to avoid a bias. Uses the generator of the calling thread, so that seeding it makes
+    // the order reproducible
+    auto& rng = mathutils::getFastRandomNumberGenerator();
 
-    for (auto& [educt, reactions] : unimolecularReactions_)
+    for (auto& [educt, reactions] : unimolecularReactions)
         std::shuffle(reactions.begin(), reactions.end(), rng);
 
-    for (auto& [educts, reactions] : bimolecularReactions_)
+    for (auto& [educts, reactions] : bimolecularReactions)
         std::shuffle(reactions.begin(), reactions.end(), rng);
+
+    return compiledReactions;
 }
 
 } // namespace cell
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include "CollisionDetector.hpp"
 #include "MathUtils.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <unordered_set>
 
@@ -20,6 +23,18 @@ using PairLookupMap = DiscTypePairMap<std::vector<Reaction>>;
 
 class ReactionEngine
 {
+public:
+    /**
+     * @brief Lookup tables compiled from a ReactionTable. Never changed after compilation: New reactions are compiled
+     * into a new instance, and readers that still hold the old one can keep using it
+     */
+    struct CompiledReactions
+    {
+        std::uint64_t version = 0;
+        SingleLookupMap unimolecularReactions;
+        PairLookupMap bimolecularReactions;
+    };
+
 public:
     ReactionEngine(const DiscTypeRegistry& discTypeRegistry, const ReactionTable& reactionTable);
 
@@ -50,18 +65,38 @@ public:
     void applyBimolecularReactions(const std::vector<CollisionDetector::Collision>& collisions,
                                    std::vector<Disc>& newDiscs) const;
 
+    /**
+     * @brief Compiles the reactions currently in the table into a new version that replaces the active one before the
+     * next update, see activatePendingReactions(). Thread-safe, can be called while the simulation is running
+     */
+    void setReactions(const ReactionTable& reactionTable);
+
+    /**
+     * @brief Makes the most recently set reactions the active ones, if there are any. Called by the cell at the start
+     * of an update, so that all reactions during an update come from the same version
+     */
+    void activatePendingReactions() const;
+
+    /**
+     * @brief The reactions used in the updates. Only safe to call from the thread running the updates
+     */
+    std::shared_ptr<const CompiledReactions> getActiveReactions() const;
+
 private:
     template <typename MapType, typename KeyType, typename Condition>
     const Reaction* selectReaction(const MapType& map, const KeyType& key, const Condition& condition) const;
 
     const Reaction* selectUnimolecularReaction(const DiscTypeID& key, double dt) const;
     const Reaction* selectBimolecularReaction(const std::pair<DiscTypeID, DiscTypeID>& key) const;
-    void combineReactionsIntoSingleMaps(const ReactionTable& reactionTable);
+    std::shared_ptr<const CompiledReactions> compile(const ReactionTable& reactionTable);
 
 private:
     const DiscTypeRegistry& discTypeRegistry_;
-    SingleLookupMap unimolecularReactions_;
-    PairLookupMap bimolecularReactions_;
+    std::atomic<std::uint64_t> latestVersion_ = 0;
+
+    // Swapped between updates only, the hot paths then read active_ without any synchronization
+    mutable std::shared_ptr<const CompiledReactions> active_;
+    mutable std::atomic<std::shared_ptr<const CompiledReactions>> pending_;
 };
 
 template <typename MapType, typename KeyType, typename Condition>
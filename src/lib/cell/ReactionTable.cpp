@@ -48,6 +48,16 @@ void ReactionTable::setReactions(const std::vector<Reaction>& reactions)
     createLookupMaps();
 }
 
+void ReactionTable::setProbability(const Reaction& reaction, double probability)
+{
+    auto iter = std::find(reactions_.begin(), reactions_.end(), reaction);
+    if (iter == reactions_.end())
+        throw ExceptionWithLocation("Reaction \"" + toString(reaction, discTypeRegistry_) + "\" doesn't exist");
+
+    iter->setProbability(probability);
+    createLookupMaps();
+}
+
 void ReactionTable::removeDiscType(DiscTypeID discTypeToRemove)
 {
     std::vector<Reaction> remainingReactions;
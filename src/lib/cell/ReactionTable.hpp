@@ -36,6 +36,12 @@ public:
      */
     void setReactions(const std::vector<Reaction>& reactions);
 
+    /**
+     * @brief Sets the probability of the reaction in the table that has the same educts and products as the given one.
+     * Throws if there is no such reaction
+     */
+    void setProbability(const Reaction& reaction, double probability);
+
     /**
      * @brief Removes all reactions where the given disc types are part of the educts or products
      * @param discTypesToRemove A vector containing disc types that are to be removed. Their IDs must match with the
@@ -0,0 +1,154 @@
+#include "ResultCache.hpp"
+#include "ExceptionWithLocation.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using json = nlohmann::json;
+
+namespace cell
+{
+
+namespace
+{
+constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+// Written last when storing, an entry without it is incomplete and ignored
+const fs::path EntryFileName = "entry.json";
+const fs::path CheckpointFileName = "checkpoint.json";
+const fs::path TypeCountsFileName = "typeCounts.csv";
+
+void clearDistribution(config::MembraneType& membraneType)
+{
+    membraneType.discCount = 0;
+    membraneType.discTypeDistribution.clear();
+}
+
+/**
+ * @brief Dumped json objects have sorted keys, so equal keys always have the same string representation
+ */
+json toNormalizedJson(const ResultCache::Key& key)
+{
+    const SimulationConfig defaults;
+    auto simulationConfig = key.simulationConfig;
+    simulationConfig.simulationTimeScale = defaults.simulationTimeScale;
+    simulationConfig.qualityOfService = defaults.qualityOfService;
+
+    if (simulationConfig.useDistribution)
+        simulationConfig.discs.clear();
+    else
+    {
+        simulationConfig.populationMode = defaults.populationMode;
+        simulationConfig.populationRelaxationSweeps = defaults.populationRelaxationSweeps;
+        clearDistribution(simulationConfig.cellMembraneType);
+        for (auto& membraneType : simulationConfig.membraneTypes)
+            clearDistribution(membraneType);
+    }
+
+    return json{{"config", simulationConfig},
+                {"seed", key.seed ? json(*key.seed) : json(nullptr)},
+                {"storageInterval", key.storageInterval.count()}};
+}
+
+void writeJson(const fs::path& path, const json& j)
+{
+    std::ofstream file(path);
+    if (!file)
+        throw ExceptionWithLocation("Couldn't open file '" + path.string() + "' for writing");
+
+    file << j.dump(4);
+}
+
+} // namespace
+
+ResultCache::ResultCache(fs::path directory)
+    : directory_(std::move(directory))
+{
+}
+
+std::optional<ResultCache::Entry> ResultCache::find(const Key& key) const
+{
+    const auto entryDirectory = getEntryDirectory(key);
+    std::ifstream entryFile(entryDirectory / EntryFileName);
+    if (!entryFile)
+        return std::nullopt;
+
+    // Entries with the same hash but a different key are treated as missing and overwritten when storing
+    const auto entryJson = json::parse(entryFile, nullptr, false);
+    if (entryJson.is_discarded() || !entryJson.contains("key") ||
+        entryJson["key"].dump() != toNormalizedJson(key).dump())
+        return std::nullopt;
+
+    std::ifstream checkpointFile(entryDirectory / CheckpointFileName);
+    const auto checkpointJson = json::parse(checkpointFile);
+
+    return Entry{.typeCountsFile = entryDirectory / TypeCountsFileName,
+                 .duration = ch::nanoseconds{entryJson["duration"].get<long long>()},
+                 .checkpoint = checkpointJson["config"].get<SimulationConfig>()};
+}
+
+void ResultCache::store(const Key& key, const fs::path& typeCountsFile, const ch::nanoseconds& duration,
+                        const SimulationConfig& checkpoint)
+{
+    if (duration % key.storageInterval != ch::nanoseconds{0})
+        throw ExceptionWithLocation("Only durations that are a multiple of the storage interval can be cached");
+
+    const auto entryDirectory = getEntryDirectory(key);
+    fs::create_directories(entryDirectory);
+    fs::remove(entryDirectory / EntryFileName);
+
+    fs::copy_file(typeCountsFile, entryDirectory / TypeCountsFileName, fs::copy_options::overwrite_existing);
+    writeJson(entryDirectory / CheckpointFileName, json{{"config", checkpoint}});
+    writeJson(entryDirectory / EntryFileName, json{{"duration", duration.count()}, {"key", toNormalizedJson(key)}});
+}
+
+void ResultCache::writeTypeCounts(const Key& key, const Entry& entry, const fs::path& outFile,
+                                  const ch::nanoseconds& duration) const
+{
+    std::ifstream in(entry.typeCountsFile);
+    if (!in)
+        throw ExceptionWithLocation("Couldn't open file '" + entry.typeCountsFile.string() + "' for reading");
+
+    std::ofstream out(outFile, std::ios::out | std::ios::trunc);
+    if (!out)
+        throw ExceptionWithLocation("Couldn't open file '" + outFile.string() + "' for writing");
+
+    // Elapsed times are written with limited precision, half a storage interval of tolerance keeps the last row
+    const auto maxTime = ch::duration<double>(duration + key.storageInterval / 2).count();
+
+    std::string line;
+    if (std::getline(in, line))
+        out << line << "\n";
+
+    while (std::getline(in, line))
+    {
+        if (std::stod(line.substr(0, line.find(','))) > maxTime)
+            break;
+
+        out << line << "\n";
+    }
+}
+
+std::string ResultCache::hash(const Key& key)
+{
+    std::uint64_t hash = FnvOffsetBasis;
+    for (const auto c : toNormalizedJson(key).dump())
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FnvPrime;
+    }
+
+    std::ostringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+    return hex.str();
+}
+
+fs::path ResultCache::getEntryDirectory(const Key& key) const
+{
+    return directory_ / hash(key);
+}
+
+} // namespace cell
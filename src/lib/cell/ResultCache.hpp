@@ -0,0 +1,80 @@
+#ifndef A20B85DF_A6E2_4730_9B38_1492D8EF41C6_HPP
+#define A20B85DF_A6E2_4730_9B38_1492D8EF41C6_HPP
+
+#include "SimulationConfig.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace ch = std::chrono;
+
+namespace cell
+{
+
+/**
+ * @brief Directory with the results of finished runs, one subdirectory per run named after the hash of its key. An
+ * entry holds the type counts csv, the simulated duration and a checkpoint of the final state of the cell, so that a
+ * longer run with the same key can continue from there instead of starting over
+ */
+class ResultCache
+{
+public:
+    /**
+     * @brief Everything that determines the result of a run, except for its duration
+     */
+    struct Key
+    {
+        SimulationConfig simulationConfig;
+        std::optional<std::uint64_t> seed;
+        ch::nanoseconds storageInterval;
+    };
+
+    struct Entry
+    {
+        fs::path typeCountsFile;
+        ch::nanoseconds duration;
+        SimulationConfig checkpoint;
+    };
+
+public:
+    explicit ResultCache(fs::path directory);
+
+    /**
+     * @returns The entry stored for the key, if there is one
+     */
+    std::optional<Entry> find(const Key& key) const;
+
+    /**
+     * @brief Replaces the entry for the key with a copy of the type counts file. The duration must be a multiple of the
+     * storage interval, the recorder doesn't write the data point of a last partial interval that a longer run would
+     * continue after
+     */
+    void store(const Key& key, const fs::path& typeCountsFile, const ch::nanoseconds& duration,
+               const SimulationConfig& checkpoint);
+
+    /**
+     * @brief Writes the rows of the cached type counts that were recorded within the first `duration` to `outFile`
+     */
+    void writeTypeCounts(const Key& key, const Entry& entry, const fs::path& outFile,
+                         const ch::nanoseconds& duration) const;
+
+    /**
+     * @returns 64 bit FNV-1a hash of the normalized key as hex string. Settings that don't change the result of an
+     * unpaced run, like the time scale, are left out of the hash, and so is whatever the population mode doesn't use
+     */
+    static std::string hash(const Key& key);
+
+private:
+    fs::path getEntryDirectory(const Key& key) const;
+
+private:
+    fs::path directory_;
+};
+
+} // namespace cell
+
+#endif /* A20B85DF_A6E2_4730_9B38_1492D8EF41C6_HPP */
@@ -0,0 +1,75 @@
+#ifndef E67853DA_2370_49F3_9CF4_03BAF56B4E29_HPP
+#define E67853DA_2370_49F3_9CF4_03BAF56B4E29_HPP
+
+#include "MembraneType.hpp"
+#include "SimulationConfig.hpp"
+#include "Vector2d.hpp"
+
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Edits that can be applied to a built cell between 2 simulation steps, without rebuilding the cell. Types are
+ * referenced by name like in the config
+ */
+namespace command
+{
+
+/**
+ * @brief Inserts the disc into the innermost compartment that contains it. The disc must not intersect any membrane
+ */
+struct InsertDisc
+{
+    config::Disc disc;
+};
+
+/**
+ * @brief Removes all discs whose centers are inside the given circle, in all compartments
+ */
+struct RemoveDiscs
+{
+    Vector2d center;
+    double radius = 0;
+};
+
+struct AddReaction
+{
+    config::Reaction reaction;
+};
+
+/**
+ * @brief Sets the probability of the existing reaction with the same educts and products to `reaction.probability`
+ */
+struct SetReactionProbability
+{
+    config::Reaction reaction;
+};
+
+/**
+ * @brief Replaces all reactions at once
+ */
+struct SetReactions
+{
+    std::vector<config::Reaction> reactions;
+};
+
+struct SetPermeability
+{
+    std::string membraneTypeName;
+    std::string discTypeName;
+    MembraneType::Permeability permeability = MembraneType::Permeability::None;
+};
+
+} // namespace command
+
+using SimulationCommand =
+    std::variant<command::InsertDisc, command::RemoveDiscs, command::AddReaction, command::SetReactionProbability,
+                 command::SetReactions, command::SetPermeability>;
+
+} // namespace cell
+
+#endif /* E67853DA_2370_49F3_9CF4_03BAF56B4E29_HPP */
@@ -25,6 +25,28 @@ inline const double cellMembraneTypeDefaultRadius = 1000;
 using PermeabilityMap = std::unordered_map<std::string, cell::MembraneType::Permeability>;
 using DiscTypeDistribution = std::unordered_map<std::string, double>;
 
+/**
+ * @brief TimeStepped moves all discs by a fixed step and resolves the overlaps found afterwards. EventDriven computes
+ * the exact collision times within a step and processes the collisions in order, which is much faster for dilute
+ * systems where most steps would contain no collisions at all
+ */
+enum class CollisionEngine
+{
+    TimeStepped,
+    EventDriven
+};
+
+/**
+ * @brief How discs are placed if distributions are used. Grid puts them on a shuffled grid spaced for the largest disc
+ * type. PoissonDisc places them randomly with a distance depending on the radii of both discs, which fits more small
+ * discs and starts without a lattice structure
+ */
+enum class PopulationMode
+{
+    Grid,
+    PoissonDisc
+};
+
 struct DiscType
 {
     std::string name;
@@ -38,6 +60,10 @@ struct Disc
     std::string discTypeName;
     double x = 0, y = 0;
     double vx = 0, vy = 0;
+
+    // Only used when populating from `discs`: 0 for the cell, i + 1 for the compartment of membranes[i] and -1 for the
+    // innermost compartment that fully contains the disc. Discs crossing a membrane can belong to either side
+    int compartment = -1;
     bool operator==(const Disc&) const = default;
 };
 
@@ -68,6 +94,20 @@ struct Reaction
     bool operator==(const Reaction&) const = default;
 };
 
+/**
+ * @brief Limits within which a simulation that is paced with its time scale may trade fidelity for speed when it can't
+ * keep up. Each lever is doubled in turn until it reaches its limit: frame interval first, then the number of updates
+ * per recorded sample, then the time step. A limit of 1 disables the lever
+ */
+struct QualityOfService
+{
+    bool enabled = false;
+    int maxFrameIntervalFactor = 4;
+    int maxRecordingStride = 4;
+    double maxTimeStepFactor = 2;
+    bool operator==(const QualityOfService&) const = default;
+};
+
 } // namespace config
 
 struct SimulationConfig
@@ -93,9 +133,58 @@ struct SimulationConfig
      * call the update() method of the world 2 * 1000/simulationTimeStep_ times per second
      */
     double simulationTimeScale = 1;
+
+    /**
+     * @brief If enabled, `simulationTimeStep` is ignored and the time step is chosen before each update such that no
+     * disc moves further than `maxDisplacementFraction` of its radius, clamped to [minTimeStep, maxTimeStep]
+     * (nanoseconds). Quiet phases of a simulation then take large steps, fast phases small ones
+     */
+    bool useAdaptiveTimeStep = false;
+    long long minTimeStep = ch::microseconds{10}.count();
+    long long maxTimeStep = ch::milliseconds{10}.count();
+    double maxDisplacementFraction = 0.25;
+
+    config::CollisionEngine collisionEngine = config::CollisionEngine::TimeStepped;
+
+    /**
+     * @brief Number of sub-steps the time-stepped engine divides every simulation step into. Only collision detection,
+     * collision resolution, bimolecular reactions and disc movement run on every sub-step, unimolecular reactions,
+     * clean-up and recording still happen once per step. Larger values allow larger steps without discs passing
+     * through each other, at a lower cost than making the step smaller
+     */
+    int collisionSubsteps = 1;
+
+    /**
+     * @brief If > 0, the time-stepped engine keeps a list of disc pairs that are closer than this distance and only
+     * checks these pairs for collisions, until some disc might have moved by more than half of it. Pays off in dense
+     * systems where neighbors change slowly. The list is also rebuilt whenever discs are added or removed
+     */
+    double neighborListSkin = 0;
+
+    /**
+     * @brief If enabled, the time-stepped engine remembers which disc pairs it resolved in the last step. Such a pair
+     * usually still overlaps in the next step while moving apart, it's then neither resolved, counted nor checked for
+     * a bimolecular reaction again
+     */
+    bool useContactCache = false;
+
+    /**
+     * @brief Number of threads that share per-disc passes (like moving the discs) in large compartments, including
+     * the simulation thread. 1 keeps the whole simulation on a single thread
+     */
+    int workerThreads = 1;
+
     double mostProbableSpeed = 600;
     bool useDistribution = true;
+    config::PopulationMode populationMode = config::PopulationMode::Grid;
+
+    /**
+     * @brief Number of random sweeps over all discs after populating with PoissonDisc, each disc is moved by about the
+     * gap between discs if it doesn't overlap anything there
+     */
+    int populationRelaxationSweeps = 0;
     bool reactionsConserveArea = false;
+    config::QualityOfService qualityOfService;
 
     // In case of no distribution, these are used
     std::vector<config::Disc> discs;
@@ -109,16 +198,22 @@ namespace config
 {
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(DiscType, name, radius, mass)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Disc, discTypeName, x, y, vx, vy)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(Disc, discTypeName, x, y, vx, vy, compartment)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(MembraneType, name, radius, permeabilityMap, discCount, discTypeDistribution)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Membrane, membraneTypeName, x, y)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Reaction, educt1, educt2, product1, product2, probability)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(QualityOfService, enabled, maxFrameIntervalFactor, maxRecordingStride,
+                                                maxTimeStepFactor)
 
 } // namespace config
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SimulationConfig, discTypes, membraneTypes, reactions, cellMembraneType,
-                                                simulationTimeStep, simulationTimeScale, mostProbableSpeed,
-                                                useDistribution, reactionsConserveArea, discs, membranes)
+                                                simulationTimeStep, simulationTimeScale, useAdaptiveTimeStep,
+                                                minTimeStep, maxTimeStep, maxDisplacementFraction, collisionEngine,
+                                                collisionSubsteps, neighborListSkin, useContactCache, workerThreads,
+                                                mostProbableSpeed, useDistribution, populationMode,
+                                                populationRelaxationSweeps, reactionsConserveArea, qualityOfService,
+                                                discs, membranes)
 
 cell::config::MembraneType& findMembraneTypeByName(cell::SimulationConfig& simulationConfig,
                                                    std::string membraneTypeName);
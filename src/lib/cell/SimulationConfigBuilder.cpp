@@ -85,6 +85,46 @@ void SimulationConfigBuilder::setReactionsConserveArea(bool value)
     simulationConfig_.reactionsConserveArea = value;
 }
 
+void SimulationConfigBuilder::setCollisionEngine(config::CollisionEngine collisionEngine)
+{
+    simulationConfig_.collisionEngine = collisionEngine;
+}
+
+void SimulationConfigBuilder::setCollisionSubsteps(int collisionSubsteps)
+{
+    simulationConfig_.collisionSubsteps = collisionSubsteps;
+}
+
+void SimulationConfigBuilder::setNeighborListSkin(double neighborListSkin)
+{
+    simulationConfig_.neighborListSkin = neighborListSkin;
+}
+
+void SimulationConfigBuilder::setUseContactCache(bool useContactCache)
+{
+    simulationConfig_.useContactCache = useContactCache;
+}
+
+void SimulationConfigBuilder::setWorkerThreads(int workerThreads)
+{
+    simulationConfig_.workerThreads = workerThreads;
+}
+
+void SimulationConfigBuilder::setPopulationMode(config::PopulationMode populationMode)
+{
+    simulationConfig_.populationMode = populationMode;
+}
+
+void SimulationConfigBuilder::setPopulationRelaxationSweeps(int populationRelaxationSweeps)
+{
+    simulationConfig_.populationRelaxationSweeps = populationRelaxationSweeps;
+}
+
+void SimulationConfigBuilder::setQualityOfService(const config::QualityOfService& qualityOfService)
+{
+    simulationConfig_.qualityOfService = qualityOfService;
+}
+
 const SimulationConfig& SimulationConfigBuilder::getSimulationConfig() const
 {
     return simulationConfig_;
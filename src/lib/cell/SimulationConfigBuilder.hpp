@@ -32,6 +32,14 @@ public:
     void setTimeScale(double simulationTimeScale);
     void setMostProbableSpeed(double mostProbableSpeed);
     void setReactionsConserveArea(bool value);
+    void setCollisionEngine(config::CollisionEngine collisionEngine);
+    void setCollisionSubsteps(int collisionSubsteps);
+    void setNeighborListSkin(double neighborListSkin);
+    void setUseContactCache(bool useContactCache);
+    void setWorkerThreads(int workerThreads);
+    void setPopulationMode(config::PopulationMode populationMode);
+    void setPopulationRelaxationSweeps(int populationRelaxationSweeps);
+    void setQualityOfService(const config::QualityOfService& qualityOfService);
 
     const SimulationConfig& getSimulationConfig() const;
 
@@ -9,6 +9,8 @@ namespace cell
 class ReactionEngine;
 class CollisionDetector;
 class CollisionHandler;
+struct SimulationConfig;
+class WorkerPool;
 
 struct SimulationContext
 {
@@ -16,6 +18,8 @@ struct SimulationContext
     const MembraneTypeRegistry& membraneTypeRegistry;
     const ReactionEngine& reactionEngine;
     const CollisionHandler& collisionHandler;
+    const SimulationConfig& simulationConfig;
+    WorkerPool& workerPool;
 };
 
 } // namespace cell
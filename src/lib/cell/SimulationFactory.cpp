@@ -9,34 +9,107 @@
 #include "ReactionTable.hpp"
 #include "SimulationContext.hpp"
 #include "StringUtils.hpp"
+#include "WorkerPool.hpp"
 
+#include <algorithm>
 #include <random>
 
 namespace cell
 {
 
+namespace
+{
+
+/**
+ * @returns The innermost compartment that fully contains the circle, nullptr if the circle intersects a membrane
+ */
+Compartment* findInnermostCompartment(Compartment& compartment, const Vector2d& center, double radius,
+                                      const MembraneTypeRegistry& membraneTypeRegistry)
+{
+    for (auto& child : compartment.getCompartments())
+    {
+        const auto& membrane = child->getMembrane();
+        const auto membraneRadius = membraneTypeRegistry.getByID(membrane.getTypeID()).getRadius();
+
+        if (mathutils::circleIsFullyContainedByCircle(center, radius, membrane.getPosition(), membraneRadius))
+            return findInnermostCompartment(*child, center, radius, membraneTypeRegistry);
+
+        if (mathutils::circlesOverlap(center, radius, membrane.getPosition(), membraneRadius))
+            return nullptr;
+    }
+
+    return &compartment;
+}
+
+} // namespace
+
 SimulationFactory::SimulationFactory() = default;
 SimulationFactory::~SimulationFactory() = default;
 
 void SimulationFactory::buildSimulationFromConfig(const SimulationConfig& simulationConfig)
+{
+    build(simulationConfig, PopulateCell{true});
+}
+
+void SimulationFactory::validateSimulationConfig(const SimulationConfig& simulationConfig)
+{
+    SimulationFactory simulationFactory;
+    simulationFactory.build(simulationConfig, PopulateCell{false});
+}
+
+void SimulationFactory::build(const SimulationConfig& simulationConfig, PopulateCell populateCell)
 {
     // Building might fail and we don't want anything dangling
     reset();
 
     try
     {
-        discTypeRegistry_ = std::make_unique<DiscTypeRegistry>(buildDiscTypeRegistry(simulationConfig));
-        membraneTypeRegistry_ = std::make_unique<MembraneTypeRegistry>(buildMembraneTypeRegistry(simulationConfig));
+        discTypeRegistry_ = std::make_shared<DiscTypeRegistry>(buildDiscTypeRegistry(simulationConfig));
+        membraneTypeRegistry_ = std::make_shared<MembraneTypeRegistry>(buildMembraneTypeRegistry(simulationConfig));
     }
     catch (const std::exception& e)
     {
         throw InvalidTypesException(e.what());
     }
 
+    buildEngines(simulationConfig, populateCell);
+
+    try
+    {
+        cell_ = buildCell(simulationConfig, populateCell);
+    }
+    catch (const std::exception& e)
+    {
+        throw InvalidSetupException(e.what());
+    }
+}
+
+void SimulationFactory::buildReplicaOf(const SimulationFactory& source, const SimulationConfig& simulationConfig)
+{
+    if (&source == this || !source.cellIsBuilt())
+        throw ExceptionWithLocation("Replicas can only be built from another factory with a built cell");
+
+    const auto& sourceConfig = *source.simulationConfig_;
+    if (simulationConfig.discTypes != sourceConfig.discTypes ||
+        simulationConfig.membraneTypes != sourceConfig.membraneTypes ||
+        simulationConfig.cellMembraneType != sourceConfig.cellMembraneType ||
+        simulationConfig.membranes != sourceConfig.membranes)
+        throw InvalidSetupException("Replicas must have the same types and membranes as the cell they're copied from");
+
+    reset();
+
+    discTypeRegistry_ = source.discTypeRegistry_;
+    membraneTypeRegistry_ = source.membraneTypeRegistry_;
+    buildEngines(simulationConfig, PopulateCell{true});
+    cell_ = source.cell_->clone(getSimulationContext());
+}
+
+void SimulationFactory::buildEngines(const SimulationConfig& simulationConfig, PopulateCell populateCell)
+{
     try
     {
-        reactionTable_ =
-            std::make_unique<ReactionTable>(buildReactionTable(simulationConfig, std::as_const(*discTypeRegistry_)));
+        reactionTable_ = std::make_unique<ReactionTable>(buildReactionTable(
+            simulationConfig.reactions, simulationConfig.reactionsConserveArea, std::as_const(*discTypeRegistry_)));
     }
     catch (const std::exception& e)
     {
@@ -49,8 +122,11 @@ void SimulationFactory::buildSimulationFromConfig(const SimulationConfig& simula
             std::make_unique<ReactionEngine>(std::as_const(*discTypeRegistry_), std::as_const(*reactionTable_));
         collisionHandler_ = std::make_unique<CollisionHandler>(std::as_const(*discTypeRegistry_),
                                                                std::as_const(*membraneTypeRegistry_));
-
-        cell_ = buildCell(simulationConfig);
+        simulationConfig_ = std::make_unique<SimulationConfig>(simulationConfig);
+        // Without discs there is nothing to share between threads
+        const auto workerThreads =
+            populateCell.value ? static_cast<std::size_t>(std::max(1, simulationConfig.workerThreads)) : 1;
+        workerPool_ = std::make_unique<WorkerPool>(workerThreads);
     }
     catch (const std::exception& e)
     {
@@ -58,15 +134,92 @@ void SimulationFactory::buildSimulationFromConfig(const SimulationConfig& simula
     }
 }
 
+void SimulationFactory::validateCommand(const SimulationCommand& command)
+{
+    executeCommand(command, ApplyCommand{false});
+}
+
+void SimulationFactory::applyCommand(const SimulationCommand& command)
+{
+    executeCommand(command, ApplyCommand{true});
+}
+
+void SimulationFactory::recompileReactions()
+{
+    if (!reactionTable_ || !reactionEngine_)
+        throw ExceptionWithLocation("Can't compile reactions, they haven't been created yet");
+
+    reactionEngine_->setReactions(*reactionTable_);
+}
+
 SimulationContext SimulationFactory::getSimulationContext() const
 {
-    if (!discTypeRegistry_ || !membraneTypeRegistry_ || !reactionEngine_ || !collisionHandler_)
+    if (!discTypeRegistry_ || !membraneTypeRegistry_ || !reactionEngine_ || !collisionHandler_ || !simulationConfig_ ||
+        !workerPool_)
         throw ExceptionWithLocation("Can't get simulation context, dependencies haven't been fully created yet");
 
     return SimulationContext{.discTypeRegistry = *discTypeRegistry_,
                              .membraneTypeRegistry = *membraneTypeRegistry_,
                              .reactionEngine = *reactionEngine_,
-                             .collisionHandler = *collisionHandler_};
+                             .collisionHandler = *collisionHandler_,
+                             .simulationConfig = *simulationConfig_,
+                             .workerPool = *workerPool_};
+}
+
+SimulationConfig SimulationFactory::createCheckpoint() const
+{
+    if (!cell_ || !simulationConfig_)
+        throw ExceptionWithLocation("Can't create checkpoint, the cell hasn't been created yet");
+
+    auto checkpoint = *simulationConfig_;
+    checkpoint.useDistribution = false;
+    checkpoint.discs.clear();
+
+    // Discs crossing a membrane can't be assigned from their position, so the checkpoint names their compartment
+    const auto getCompartmentIndex = [&](const Compartment& compartment)
+    {
+        if (&compartment == cell_.get())
+            return 0;
+
+        const auto& membrane = compartment.getMembrane();
+        const auto& membraneTypeName = membraneTypeRegistry_->getByID(membrane.getTypeID()).getName();
+        const auto& configMembranes = simulationConfig_->membranes;
+        for (std::size_t i = 0; i < configMembranes.size(); ++i)
+        {
+            if (configMembranes[i].membraneTypeName == membraneTypeName &&
+                configMembranes[i].x == membrane.getPosition().x && configMembranes[i].y == membrane.getPosition().y)
+                return static_cast<int>(i) + 1;
+        }
+
+        throw ExceptionWithLocation("Compartment at " + stringutils::toString(membrane.getPosition()) +
+                                    " has no membrane in the config");
+    };
+
+    std::vector<const Compartment*> compartments{cell_.get()};
+    while (!compartments.empty())
+    {
+        const auto* compartment = compartments.back();
+        compartments.pop_back();
+        const auto compartmentIndex = getCompartmentIndex(*compartment);
+
+        for (const auto& disc : compartment->getDiscs())
+        {
+            if (disc.isMarkedDestroyed())
+                continue;
+
+            checkpoint.discs.push_back({.discTypeName = discTypeRegistry_->getByID(disc.getTypeID()).getName(),
+                                        .x = disc.getPosition().x,
+                                        .y = disc.getPosition().y,
+                                        .vx = disc.getVelocity().x,
+                                        .vy = disc.getVelocity().y,
+                                        .compartment = compartmentIndex});
+        }
+
+        for (const auto& child : compartment->getCompartments())
+            compartments.push_back(child.get());
+    }
+
+    return checkpoint;
 }
 
 Cell& SimulationFactory::getCell()
@@ -120,23 +273,16 @@ MembraneTypeRegistry SimulationFactory::buildMembraneTypeRegistry(const Simulati
     return registry;
 }
 
-ReactionTable SimulationFactory::buildReactionTable(const SimulationConfig& simulationConfig,
-                                                    const DiscTypeRegistry& discTypeRegistry)
+ReactionTable SimulationFactory::buildReactionTable(const std::vector<config::Reaction>& reactions,
+                                                    bool reactionsConserveArea,
+                                                    const DiscTypeRegistry& discTypeRegistry) const
 {
     ReactionTable reactionTable(discTypeRegistry);
 
-    for (const auto& reaction : simulationConfig.reactions)
+    for (const auto& reaction : reactions)
     {
-        DiscTypeID educt1 = discTypeRegistry.getIDFor(reaction.educt1);
-        std::optional<DiscTypeID> educt2 =
-            reaction.educt2.empty() ? std::nullopt : std::make_optional(discTypeRegistry.getIDFor(reaction.educt2));
-
-        DiscTypeID product1 = discTypeRegistry.getIDFor(reaction.product1);
-        std::optional<DiscTypeID> product2 =
-            reaction.product2.empty() ? std::nullopt : std::make_optional(discTypeRegistry.getIDFor(reaction.product2));
-
-        Reaction newReaction(educt1, educt2, product1, product2, reaction.probability);
-        if (simulationConfig.reactionsConserveArea)
+        Reaction newReaction = convertReaction(reaction, discTypeRegistry);
+        if (reactionsConserveArea)
             newReaction.validateAreaConservation(discTypeRegistry);
 
         reactionTable.addReaction(newReaction);
@@ -145,7 +291,21 @@ ReactionTable SimulationFactory::buildReactionTable(const SimulationConfig& simu
     return reactionTable;
 }
 
-std::unique_ptr<Cell> SimulationFactory::buildCell(const SimulationConfig& simulationConfig)
+Reaction SimulationFactory::convertReaction(const config::Reaction& reaction,
+                                            const DiscTypeRegistry& discTypeRegistry) const
+{
+    DiscTypeID educt1 = discTypeRegistry.getIDFor(reaction.educt1);
+    std::optional<DiscTypeID> educt2 =
+        reaction.educt2.empty() ? std::nullopt : std::make_optional(discTypeRegistry.getIDFor(reaction.educt2));
+
+    DiscTypeID product1 = discTypeRegistry.getIDFor(reaction.product1);
+    std::optional<DiscTypeID> product2 =
+        reaction.product2.empty() ? std::nullopt : std::make_optional(discTypeRegistry.getIDFor(reaction.product2));
+
+    return Reaction(educt1, educt2, product1, product2, reaction.probability);
+}
+
+std::unique_ptr<Cell> SimulationFactory::buildCell(const SimulationConfig& simulationConfig, PopulateCell populateCell)
 {
     const auto& configMembranes = simulationConfig.membranes;
     if (std::find_if(configMembranes.begin(), configMembranes.end(), [&](const auto& membrane)
@@ -160,6 +320,19 @@ std::unique_ptr<Cell> SimulationFactory::buildCell(const SimulationConfig& simul
 
     throwIfDiscsCanBeLargerThanMembranes(simulationConfig);
 
+    if (simulationConfig.useAdaptiveTimeStep &&
+        (simulationConfig.minTimeStep <= 0 || simulationConfig.minTimeStep > simulationConfig.maxTimeStep))
+        throw ExceptionWithLocation("Adaptive time steps need 0 < minTimeStep <= maxTimeStep");
+
+    if (simulationConfig.useAdaptiveTimeStep && simulationConfig.maxDisplacementFraction <= 0)
+        throw ExceptionWithLocation("Adaptive time steps need maxDisplacementFraction > 0");
+
+    if (simulationConfig.collisionSubsteps < 1)
+        throw ExceptionWithLocation("collisionSubsteps must be at least 1");
+
+    if (simulationConfig.neighborListSkin < 0)
+        throw ExceptionWithLocation("neighborListSkin must be >= 0, 0 disables the neighbor list");
+
     std::vector<Membrane> membranes = getMembranesFromConfig(simulationConfig);
 
     Membrane cellMembrane(membraneTypeRegistry_->getIDFor(config::cellMembraneTypeName));
@@ -168,12 +341,125 @@ std::unique_ptr<Cell> SimulationFactory::buildCell(const SimulationConfig& simul
     std::unique_ptr<Cell> cell(std::make_unique<Cell>(std::move(cellMembrane), getSimulationContext()));
     createCompartments(*cell, std::move(membranes));
 
-    CellPopulator cellPopulator(*cell, simulationConfig, *discTypeRegistry_, *membraneTypeRegistry_);
-    cellPopulator.populateCell();
+    CellPopulator cellPopulator(*cell, simulationConfig, *discTypeRegistry_, *membraneTypeRegistry_, *workerPool_);
+    if (populateCell.value)
+        cellPopulator.populateCell();
+    else
+        cellPopulator.validate();
 
     return cell;
 }
 
+void SimulationFactory::executeCommand(const SimulationCommand& command, ApplyCommand applyCommand)
+{
+    if (!cell_)
+        throw ExceptionWithLocation("Can't execute command, the cell hasn't been created yet");
+
+    std::visit([&](const auto& concreteCommand) { execute(concreteCommand, applyCommand); }, command);
+}
+
+void SimulationFactory::execute(const command::InsertDisc& command, ApplyCommand applyCommand)
+{
+    const auto discTypeID = discTypeRegistry_->getIDFor(command.disc.discTypeName);
+    const auto radius = discTypeRegistry_->getByID(discTypeID).getRadius();
+    const Vector2d position{command.disc.x, command.disc.y};
+
+    const auto& cellMembrane = cell_->getMembrane();
+    const auto cellRadius = membraneTypeRegistry_->getByID(cellMembrane.getTypeID()).getRadius();
+    Compartment* compartment = nullptr;
+    if (mathutils::circleIsFullyContainedByCircle(position, radius, cellMembrane.getPosition(), cellRadius))
+        compartment = findInnermostCompartment(*cell_, position, radius, *membraneTypeRegistry_);
+
+    if (!compartment)
+        throw ExceptionWithLocation("Can't insert disc at " + stringutils::toString(position) +
+                                    ": It isn't fully contained by a compartment");
+
+    if (!applyCommand.value)
+        return;
+
+    // Overlaps with other discs are resolved by the next collision update
+    Disc disc(discTypeID);
+    disc.setPosition(position);
+    disc.setVelocity({command.disc.vx, command.disc.vy});
+    compartment->addDisc(std::move(disc));
+}
+
+void SimulationFactory::execute(const command::RemoveDiscs& command, ApplyCommand applyCommand)
+{
+    if (command.radius < 0)
+        throw ExceptionWithLocation("Can't remove discs in a circle with negative radius");
+
+    if (applyCommand.value)
+        cell_->removeDiscsInCircle(command.center, command.radius);
+}
+
+void SimulationFactory::execute(const command::AddReaction& command, ApplyCommand applyCommand)
+{
+    const auto reaction = convertReaction(command.reaction, *discTypeRegistry_);
+    reaction.validate(*discTypeRegistry_);
+    if (simulationConfig_->reactionsConserveArea)
+        reaction.validateAreaConservation(*discTypeRegistry_);
+
+    const auto& reactions = reactionTable_->getReactions();
+    const bool exists = std::find(reactions.begin(), reactions.end(), reaction) != reactions.end();
+
+    if (!applyCommand.value)
+    {
+        if (exists)
+            throw ExceptionWithLocation("Duplicate reaction \"" + toString(reaction, *discTypeRegistry_) + "\"");
+
+        return;
+    }
+
+    // The same reaction might have been validated twice before the first one was applied
+    if (exists)
+        return;
+
+    reactionTable_->addReaction(reaction);
+    reactionEngine_->setReactions(*reactionTable_);
+}
+
+void SimulationFactory::execute(const command::SetReactionProbability& command, ApplyCommand applyCommand)
+{
+    const auto reaction = convertReaction(command.reaction, *discTypeRegistry_);
+    const auto& reactions = reactionTable_->getReactions();
+    if (std::find(reactions.begin(), reactions.end(), reaction) == reactions.end())
+        throw ExceptionWithLocation("Reaction \"" + toString(reaction, *discTypeRegistry_) + "\" doesn't exist");
+
+    if (!applyCommand.value)
+        return;
+
+    reactionTable_->setProbability(reaction, reaction.getProbability());
+    reactionEngine_->setReactions(*reactionTable_);
+}
+
+void SimulationFactory::execute(const command::SetReactions& command, ApplyCommand applyCommand)
+{
+    const auto reactionTable =
+        buildReactionTable(command.reactions, simulationConfig_->reactionsConserveArea, *discTypeRegistry_);
+    if (!applyCommand.value)
+        return;
+
+    reactionTable_->setReactions(reactionTable.getReactions());
+    reactionEngine_->setReactions(*reactionTable_);
+}
+
+void SimulationFactory::execute(const command::SetPermeability& command, ApplyCommand applyCommand)
+{
+    const auto membraneTypeID = membraneTypeRegistry_->getIDFor(command.membraneTypeName);
+    const auto discTypeID = discTypeRegistry_->getIDFor(command.discTypeName);
+
+    if (command.membraneTypeName == config::cellMembraneTypeName &&
+        command.permeability != MembraneType::Permeability::None)
+        throw ExceptionWithLocation("Currently the outer cell membrane does not support permeability");
+
+    if (membraneTypeRegistry_.use_count() > 1)
+        throw ExceptionWithLocation("Permeabilities can't be changed while membrane types are shared with replicas");
+
+    if (applyCommand.value)
+        membraneTypeRegistry_->getByID(membraneTypeID).setPermeabilityFor(discTypeID, command.permeability);
+}
+
 std::vector<Membrane> SimulationFactory::getMembranesFromConfig(const SimulationConfig& simulationConfig_)
 {
     std::vector<Membrane> membranes;
@@ -196,7 +482,9 @@ void SimulationFactory::reset()
     reactionTable_.reset();
     reactionEngine_.reset();
     collisionHandler_.reset();
+    simulationConfig_.reset();
     cell_.reset();
+    workerPool_.reset();
 }
 
 void SimulationFactory::createCompartments(Cell& cell, std::vector<Membrane> membranes)
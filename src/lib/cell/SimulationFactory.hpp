@@ -1,6 +1,7 @@
 #ifndef EAA46EC4_DDB5_4CF5_A61A_8BC66872C559_HPP
 #define EAA46EC4_DDB5_4CF5_A61A_8BC66872C559_HPP
 
+#include "SimulationCommand.hpp"
 #include "SimulationConfig.hpp"
 
 namespace cell
@@ -29,6 +30,8 @@ class ReactionEngine;
 class CollisionDetector;
 class CollisionHandler;
 class Membrane;
+class Reaction;
+class WorkerPool;
 
 class SimulationFactory
 {
@@ -37,17 +40,79 @@ public:
     ~SimulationFactory();
 
     void buildSimulationFromConfig(const SimulationConfig& simulationConfig);
+
+    /**
+     * @brief Builds a simulation with a deep copy of the cell of `source` instead of populating a new one. The type
+     * registries are shared with `source`, everything else (reactions, config, worker threads) is built from the given
+     * config, which must have the same types and membranes as the config of `source`. Permeabilities can't be changed
+     * while registries are shared
+     */
+    void buildReplicaOf(const SimulationFactory& source, const SimulationConfig& simulationConfig);
+
+    /**
+     * @brief Runs the same checks as buildSimulationFromConfig() and throws the same exceptions, but doesn't populate
+     * the cell with discs, so it's cheap even for large configs
+     */
+    static void validateSimulationConfig(const SimulationConfig& simulationConfig);
+
+    /**
+     * @brief Throws if the command can't be applied to the current cell, e.g. because of an unknown type name
+     */
+    void validateCommand(const SimulationCommand& command);
+
+    /**
+     * @brief Validates the command and applies it to the cell in place. Commands don't change the config the cell was
+     * built from. Must not be called during an update
+     */
+    void applyCommand(const SimulationCommand& command);
+
+    /**
+     * @brief Compiles the current reactions again, which shuffles them with the random number generators of the
+     * calling thread. The runner does this after seeding them, so that a seed also fixes the order of the reactions
+     */
+    void recompileReactions();
+
     SimulationContext getSimulationContext() const;
 
+    /**
+     * @brief Config that rebuilds the current state of the cell: the config the cell was built from, but with every
+     * disc placed directly at its current position and with its current velocity instead of using the distributions
+     */
+    SimulationConfig createCheckpoint() const;
+
     Cell& getCell();
     bool cellIsBuilt() const;
 
 private:
-    ReactionTable buildReactionTable(const SimulationConfig& simulationConfig,
-                                     const DiscTypeRegistry& discTypeRegistry);
+    struct PopulateCell
+    {
+        bool value = true;
+    };
+
+    struct ApplyCommand
+    {
+        bool value = true;
+    };
+
+    void build(const SimulationConfig& simulationConfig, PopulateCell populateCell);
+
+    /**
+     * @brief Builds everything between the type registries and the cell
+     */
+    void buildEngines(const SimulationConfig& simulationConfig, PopulateCell populateCell);
+    void executeCommand(const SimulationCommand& command, ApplyCommand applyCommand);
+    void execute(const command::InsertDisc& command, ApplyCommand applyCommand);
+    void execute(const command::RemoveDiscs& command, ApplyCommand applyCommand);
+    void execute(const command::AddReaction& command, ApplyCommand applyCommand);
+    void execute(const command::SetReactionProbability& command, ApplyCommand applyCommand);
+    void execute(const command::SetReactions& command, ApplyCommand applyCommand);
+    void execute(const command::SetPermeability& command, ApplyCommand applyCommand);
+    Reaction convertReaction(const config::Reaction& reaction, const DiscTypeRegistry& discTypeRegistry) const;
+    ReactionTable buildReactionTable(const std::vector<config::Reaction>& reactions, bool reactionsConserveArea,
+                                     const DiscTypeRegistry& discTypeRegistry) const;
     DiscTypeRegistry buildDiscTypeRegistry(const SimulationConfig& simulationConfig);
     MembraneTypeRegistry buildMembraneTypeRegistry(const SimulationConfig& simulationConfig);
-    std::unique_ptr<Cell> buildCell(const SimulationConfig& simulationConfig);
+    std::unique_ptr<Cell> buildCell(const SimulationConfig& simulationConfig, PopulateCell populateCell);
     std::vector<Membrane> getMembranesFromConfig(const SimulationConfig& simulationConfig);
     void reset();
     void createCompartments(Cell& cell, std::vector<Membrane> membranes);
@@ -55,11 +120,13 @@ private:
     void throwIfDiscsCanBeLargerThanMembranes(const SimulationConfig& config) const;
 
 private:
-    std::unique_ptr<DiscTypeRegistry> discTypeRegistry_;
-    std::unique_ptr<MembraneTypeRegistry> membraneTypeRegistry_;
+    std::shared_ptr<DiscTypeRegistry> discTypeRegistry_;
+    std::shared_ptr<MembraneTypeRegistry> membraneTypeRegistry_;
     std::unique_ptr<ReactionTable> reactionTable_;
     std::unique_ptr<ReactionEngine> reactionEngine_;
     std::unique_ptr<CollisionHandler> collisionHandler_;
+    std::unique_ptr<SimulationConfig> simulationConfig_;
+    std::unique_ptr<WorkerPool> workerPool_;
     std::unique_ptr<Cell> cell_;
 };
 
@@ -14,23 +14,35 @@ void SimulationRecordSerializer::writeTypeCountsToCsv(const std::deque<DataPoint
         throw ExceptionWithLocation("Couldn't open file '" + outFile.string() + "' for writing");
 
     ch::nanoseconds elapsedTime{};
-    const auto& discTypes = discTypeRegistry.getValues();
     std::vector<DiscTypeID> discTypeIDs = discTypeRegistry.getIDs();
 
-    file << "ElapsedTime[s]";
-    for (const auto& discType : discTypes)
-        file << "," << discType.getName();
-    file << "\n";
+    writeTypeCountsCsvHeader(file, discTypeRegistry);
 
     for (const auto& dataPoint : dataPoints)
     {
         elapsedTime += dataPoint.getData().elapsedTime;
-        file << ch::duration<double>(elapsedTime).count();
-        for (const auto& ID : discTypeIDs)
-            file << ","
-                 << ((dataPoint.getData().discTypeCounts.contains(ID)) ? dataPoint.getData().discTypeCounts.at(ID) : 0);
-        file << "\n";
+        writeTypeCountsCsvRow(file, dataPoint, elapsedTime, discTypeIDs);
     }
 }
 
+void SimulationRecordSerializer::writeTypeCountsCsvHeader(std::ostream& out, const DiscTypeRegistry& discTypeRegistry)
+{
+    out << "ElapsedTime[s]";
+    for (const auto& discType : discTypeRegistry.getValues())
+        out << "," << discType.getName();
+    out << "\n";
+}
+
+void SimulationRecordSerializer::writeTypeCountsCsvRow(std::ostream& out, const DataPoint& dataPoint,
+                                                       const ch::nanoseconds& elapsedTime,
+                                                       const std::vector<DiscTypeID>& discTypeIDs)
+{
+    const auto& discTypeCounts = dataPoint.getData().discTypeCounts;
+
+    out << ch::duration<double>(elapsedTime).count();
+    for (const auto& ID : discTypeIDs)
+        out << "," << (discTypeCounts.contains(ID) ? discTypeCounts.at(ID) : 0);
+    out << "\n";
+}
+
 } // namespace cell
\ No newline at end of file
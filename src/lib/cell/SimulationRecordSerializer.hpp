@@ -5,6 +5,7 @@
 #include "Types.hpp"
 
 #include <deque>
+#include <ostream>
 
 namespace cell
 {
@@ -14,6 +15,14 @@ class SimulationRecordSerializer
 public:
     void writeTypeCountsToCsv(const std::deque<DataPoint>& dataPoints, const DiscTypeRegistry& discTypeRegistry,
                               const fs::path& outFile);
+
+    void writeTypeCountsCsvHeader(std::ostream& out, const DiscTypeRegistry& discTypeRegistry);
+
+    /**
+     * @param elapsedTime Total simulation time up to and including the given data point
+     */
+    void writeTypeCountsCsvRow(std::ostream& out, const DataPoint& dataPoint, const ch::nanoseconds& elapsedTime,
+                               const std::vector<DiscTypeID>& discTypeIDs);
 };
 
 } // namespace cell
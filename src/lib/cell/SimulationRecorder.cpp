@@ -3,13 +3,13 @@
 #include "MathUtils.hpp"
 #include "StringUtils.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace cell
 {
 
 SimulationRecorder::SimulationRecorder(const DiscTypeRegistry& discTypeRegistry, double vSigma)
-    : discTypeRegistry_(discTypeRegistry)
 {
     std::vector<DiscTypeID> discTypeIDs = discTypeRegistry.getIDs();
     currentDataPoint_.initializeHistograms(discTypeIDs, vSigma);
@@ -27,38 +27,70 @@ void SimulationRecorder::printPerformanceData(SimulationRunner::PerformanceData
     std::cout << "Time per simulation update: " << stringutils::timeString(data.timePerSimulationUpdate.count())
               << "\n";
     std::cout << "Time per update: " << stringutils::timeString(data.timePerWholeUpdate.count()) << "\n";
+    std::cout << "Time step: " << stringutils::timeString(data.timeStep.count()) << "\n";
+    std::cout << "Load: " << data.load << "\n";
+    if (data.updatesPerBatch > 0)
+        std::cout << "Pacing error: " << stringutils::timeString(data.pacingError.count()) << " ("
+                  << data.updatesPerBatch << " updates per batch)\n";
     std::cout << std::endl;
 }
 
 void SimulationRecorder::processInitialSimulationData(Cell& cell)
 {
-    currentDataPoint_.addSimulationData(cell, ch::seconds{0}, discTypeRegistry_);
-    dataPoints_.push_back(currentDataPoint_);
+    currentDataPoint_.addSimulationData(cell, ch::seconds{0});
+    dataPointSink_->add(currentDataPoint_);
     currentDataPoint_.clear();
-    recordFrame(cell);
+    publishFrame(cell);
 }
 
 void SimulationRecorder::processSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime)
 {
-    currentDataPoint_.addSimulationData(cell, elapsedTime, discTypeRegistry_);
     recordFrame(cell);
+
+    unsampledTime_ += elapsedTime;
+    if (++unsampledUpdates_ < samplingStride_)
+        return;
+
+    currentDataPoint_.addSimulationData(cell, unsampledTime_);
+    unsampledUpdates_ = 0;
+    unsampledTime_ = ch::nanoseconds{0};
     storeDataPoint();
 }
 
 void SimulationRecorder::storeRemainingData()
 {
     storeDataPoint();
+    dataPointSink_->flush();
+}
+
+void SimulationRecorder::setDataPointSink(std::unique_ptr<DataPointSink> dataPointSink)
+{
+    if (!dataPointSink)
+        throw ExceptionWithLocation("Data point sink can't be null");
+
+    dataPointSink_ = std::move(dataPointSink);
+}
+
+const DataPointSink& SimulationRecorder::getDataPointSink() const
+{
+    return *dataPointSink_;
 }
 
 const std::deque<DataPoint>& SimulationRecorder::getDataPoints() const
 {
-    return dataPoints_;
+    const auto* inMemorySink = dynamic_cast<const InMemoryDataPointSink*>(dataPointSink_.get());
+    if (!inMemorySink)
+        throw ExceptionWithLocation("The current data point sink doesn't keep data points in memory");
+
+    return inMemorySink->getDataPoints();
 }
 
 void SimulationRecorder::clear()
 {
     currentDataPoint_.clear();
-    dataPoints_.clear();
+    dataPointSink_->clear();
+    unsampledUpdates_ = 0;
+    unsampledTime_ = ch::nanoseconds{0};
 }
 
 void SimulationRecorder::setRecordLastFrame(bool value)
@@ -66,9 +98,53 @@ void SimulationRecorder::setRecordLastFrame(bool value)
     recordLastFrame_ = value;
 }
 
-SimulationRecorder::Frame SimulationRecorder::getLastFrame()
+void SimulationRecorder::setFrameInterval(const ch::nanoseconds& frameInterval)
+{
+    frameInterval_.store(frameInterval, std::memory_order_relaxed);
+}
+
+void SimulationRecorder::setFrameIntervalFactor(int frameIntervalFactor)
 {
-    return lastFrame_;
+    frameIntervalFactor_ = std::max(1, frameIntervalFactor);
+}
+
+void SimulationRecorder::setSamplingStride(int samplingStride)
+{
+    samplingStride_ = std::max(1, samplingStride);
+}
+
+void SimulationRecorder::publishFrame(const Cell& cell)
+{
+    if (!recordLastFrame_)
+        return;
+
+    auto& frame = frames_.getWriteBuffer();
+    frame.clear();
+
+    std::vector<const Compartment*> compartments({&cell});
+    while (!compartments.empty())
+    {
+        const Compartment* compartment = compartments.back();
+        compartments.pop_back();
+
+        frame.discOffsets.push_back(frame.discs.size());
+        frame.discs.insert(frame.discs.end(), compartment->getDiscs().begin(), compartment->getDiscs().end());
+        frame.membranes.push_back(compartment->getMembrane());
+
+        for (const auto& subCompartment : compartment->getCompartments())
+            compartments.push_back(subCompartment.get());
+    }
+    frame.discOffsets.push_back(frame.discs.size());
+
+    frames_.publish();
+    lastFramePublishTime_ = ch::steady_clock::now();
+}
+
+const SimulationRecorder::Frame& SimulationRecorder::getLatestFrame()
+{
+    frames_.update();
+
+    return frames_.getReadBuffer();
 }
 
 void SimulationRecorder::setNewDataPointCallback(std::function<void(const DataPoint& dataPoint)> callback)
@@ -87,7 +163,7 @@ void SimulationRecorder::storeDataPoint()
         return;
 
     currentDataPoint_.average(NormalizeCollisionCounts{false});
-    dataPoints_.push_back(currentDataPoint_);
+    dataPointSink_->add(currentDataPoint_);
 
     if (newDataPointCallback_)
         newDataPointCallback_(currentDataPoint_);
@@ -100,20 +176,11 @@ void SimulationRecorder::recordFrame(const Cell& cell)
     if (!recordLastFrame_)
         return;
 
-    lastFrame_.clear();
-
-    std::vector<const Compartment*> compartments({&cell});
-    while (!compartments.empty())
-    {
-        const Compartment* compartment = compartments.back();
-        compartments.pop_back();
-
-        lastFrame_.discs.insert(lastFrame_.discs.end(), compartment->getDiscs().begin(), compartment->getDiscs().end());
-        lastFrame_.membranes.push_back(compartment->getMembrane());
+    const auto frameInterval = frameIntervalFactor_ * frameInterval_.load(std::memory_order_relaxed);
+    if (ch::steady_clock::now() - lastFramePublishTime_ < frameInterval)
+        return;
 
-        for (const auto& subCompartment : compartment->getCompartments())
-            compartments.push_back(subCompartment.get());
-    }
+    publishFrame(cell);
 }
 
 } // namespace cell
\ No newline at end of file
@@ -2,12 +2,15 @@
 #define A0298BEF_1AF7_44D4_A4ED_8921F9D116D7_HPP
 
 #include "DataPoint.hpp"
+#include "DataPointSink.hpp"
 #include "Disc.hpp"
 #include "Membrane.hpp"
 #include "SimulationRunner.hpp"
+#include "TripleBuffer.hpp"
 
 #include <boost/histogram.hpp>
 
+#include <atomic>
 #include <deque>
 
 namespace cell
@@ -21,10 +24,17 @@ public:
         std::vector<Disc> discs;
         std::vector<Membrane> membranes;
 
+        /**
+         * @brief The discs inside of membranes[i] are discs[discOffsets[i]] up to discs[discOffsets[i + 1]], so
+         * consumers can skip whole compartments
+         */
+        std::vector<std::size_t> discOffsets;
+
         void clear()
         {
             discs.clear();
             membranes.clear();
+            discOffsets.clear();
         }
     };
 
@@ -35,10 +45,49 @@ public:
     void processInitialSimulationData(Cell& cell);
     void processSimulationData(Cell& cell, const ch::nanoseconds& elapsedTime);
     void storeRemainingData();
+
+    /**
+     * @brief Replaces the sink that receives stored data points. Everything recorded so far stays in the old sink
+     */
+    void setDataPointSink(std::unique_ptr<DataPointSink> dataPointSink);
+    const DataPointSink& getDataPointSink() const;
+
+    /**
+     * @returns The data points kept in memory by the current sink. Throws if the sink doesn't keep them in memory
+     */
     const std::deque<DataPoint>& getDataPoints() const;
     void clear();
     void setRecordLastFrame(bool value);
-    Frame getLastFrame();
+
+    /**
+     * @brief Frames are published to the consumer at most once per frame interval (real time), intermediate
+     * simulation states aren't copied at all. Can be changed while the simulation is running
+     */
+    void setFrameInterval(const ch::nanoseconds& frameInterval);
+
+    /**
+     * @brief Multiplies the frame interval without changing it, to drop frames while the simulation can't keep up.
+     * Must be set from the simulation thread
+     */
+    void setFrameIntervalFactor(int frameIntervalFactor);
+
+    /**
+     * @brief Only every n-th update adds its statistics to the current data point, the time of the others is still
+     * added. Must be set from the simulation thread
+     */
+    void setSamplingStride(int samplingStride);
+
+    /**
+     * @brief Publishes the current state of the cell regardless of the frame interval, e. g. after the simulation
+     * stopped
+     */
+    void publishFrame(const Cell& cell);
+
+    /**
+     * @returns The most recently published frame. Must only be called from a single consumer thread, the reference
+     * stays valid until the next call
+     */
+    const Frame& getLatestFrame();
     void setNewDataPointCallback(std::function<void(const DataPoint& dataPoint)> callback);
     const ch::nanoseconds& getStorageInterval() const;
 
@@ -49,10 +98,15 @@ private:
 private:
     ch::nanoseconds storageInterval_ = ch::milliseconds{100};
     DataPoint currentDataPoint_;
-    std::deque<DataPoint> dataPoints_;
-    const DiscTypeRegistry& discTypeRegistry_;
+    std::unique_ptr<DataPointSink> dataPointSink_ = std::make_unique<InMemoryDataPointSink>();
     bool recordLastFrame_ = false;
-    Frame lastFrame_;
+    TripleBuffer<Frame> frames_;
+    std::atomic<ch::nanoseconds> frameInterval_ = ch::nanoseconds{0};
+    ch::steady_clock::time_point lastFramePublishTime_;
+    int frameIntervalFactor_ = 1;
+    int samplingStride_ = 1;
+    int unsampledUpdates_ = 0;
+    ch::nanoseconds unsampledTime_{0};
     std::function<void(const DataPoint&)> newDataPointCallback_;
 };
 
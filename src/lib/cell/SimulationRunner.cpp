@@ -1,7 +1,12 @@
 #include "SimulationRunner.hpp"
 #include "Cell.hpp"
+#include "ExceptionWithLocation.hpp"
+#include "MathUtils.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
+#include <limits>
 
 namespace ch = std::chrono;
 using namespace std::chrono_literals;
@@ -10,6 +15,19 @@ using json = nlohmann::json;
 namespace cell
 {
 
+namespace
+{
+// Sleeping usually wakes up a bit late, so the last part of a wait is spent spinning instead
+constexpr auto SpinDuration = 1ms;
+
+void waitUntil(ch::steady_clock::time_point time)
+{
+    std::this_thread::sleep_until(time - SpinDuration);
+    while (ch::steady_clock::now() < time)
+        std::this_thread::yield();
+}
+} // namespace
+
 void SimulationRunner::useConfigFile(const fs::path& configFile)
 {
     json j;
@@ -17,6 +35,8 @@ void SimulationRunner::useConfigFile(const fs::path& configFile)
     file >> j;
     simulationConfig_ = j["config"].get<SimulationConfig>();
     simulationFactory_.buildSimulationFromConfig(simulationConfig_);
+    updateLoopParameters({.targetScale = simulationConfig_.simulationTimeScale,
+                          .timeStep = ch::nanoseconds{simulationConfig_.simulationTimeStep}});
 
     if (postBuildCallback_)
         postBuildCallback_(simulationFactory_.getCell());
@@ -29,11 +49,32 @@ void SimulationRunner::useConfig(const SimulationConfig& simulationConfig)
 
     simulationFactory_.buildSimulationFromConfig(simulationConfig);
     simulationConfig_ = simulationConfig;
+    updateLoopParameters({.targetScale = simulationConfig_.simulationTimeScale,
+                          .timeStep = ch::nanoseconds{simulationConfig_.simulationTimeStep}});
 
     if (postBuildCallback_)
         postBuildCallback_(simulationFactory_.getCell());
 }
 
+void SimulationRunner::useReplicaOf(const SimulationRunner& source, const SimulationConfig& simulationConfig)
+{
+    if (simulationIsRunning() || source.simulationIsRunning())
+        throw ExceptionWithLocation("Replicas can't be built while the simulation or its source are running");
+
+    simulationFactory_.buildReplicaOf(source.simulationFactory_, simulationConfig);
+    simulationConfig_ = simulationConfig;
+    updateLoopParameters({.targetScale = simulationConfig_.simulationTimeScale,
+                          .timeStep = ch::nanoseconds{simulationConfig_.simulationTimeStep}});
+
+    if (postBuildCallback_)
+        postBuildCallback_(simulationFactory_.getCell());
+}
+
+void SimulationRunner::setRandomSeed(std::optional<std::uint64_t> randomSeed)
+{
+    randomSeed_ = randomSeed;
+}
+
 void SimulationRunner::setSimulationDuration(const ch::nanoseconds& simulationDuration)
 {
     simulationDuration_ = simulationDuration;
@@ -44,8 +85,17 @@ void SimulationRunner::runSimulation()
     if (simulationIsRunning())
         return;
 
+    // Set before the thread starts so that commands aren't applied directly while the first update runs
+    {
+        std::scoped_lock lock(commandMutex_);
+        isRunning_ = true;
+    }
+    {
+        std::scoped_lock lock(controlMutex_);
+        control_.paused = false;
+        control_.pendingSteps = 0;
+    }
     thread_ = std::jthread([this](std::stop_token stopToken) { loop(stopToken); });
-    isRunning_ = true;
 }
 
 void SimulationRunner::waitForSimulationToFinish()
@@ -91,16 +141,35 @@ void SimulationRunner::setPostStopCallback(std::function<void()> callback)
     postStopCallback_ = std::move(callback);
 }
 
+void SimulationRunner::setFidelityLevelCallback(
+    std::function<void(const QualityOfServiceController::FidelityLevel&)> callback)
+{
+    fidelityLevelCallback_ = std::move(callback);
+}
+
 SimulationContext SimulationRunner::getSimulationContext() const
 {
     return simulationFactory_.getSimulationContext();
 }
 
+Cell& SimulationRunner::getCell()
+{
+    return simulationFactory_.getCell();
+}
+
 const SimulationConfig& SimulationRunner::getSimulationConfig() const
 {
     return simulationConfig_;
 }
 
+SimulationConfig SimulationRunner::createCheckpoint() const
+{
+    if (simulationIsRunning())
+        throw ExceptionWithLocation("Can't create a checkpoint while the simulation is running");
+
+    return simulationFactory_.createCheckpoint();
+}
+
 void SimulationRunner::setUseScaleFromConfig(bool value)
 {
     useScaleFromConfig_ = value;
@@ -111,11 +180,56 @@ bool SimulationRunner::simulationIsRunning() const
     return isRunning_;
 }
 
+void SimulationRunner::setPacingInterval(const ch::nanoseconds& pacingInterval)
+{
+    control_.pacingInterval.store(pacingInterval.count(), std::memory_order_relaxed);
+}
+
 void SimulationRunner::updateLoopParameters(LoopParameters loopParameters)
 {
-    // Not atomic atm, doesn't need to be yet
-    simulationConfig_.simulationTimeScale = loopParameters.targetScale;
-    simulationConfig_.simulationTimeStep = loopParameters.timeStep.count();
+    std::scoped_lock lock(controlMutex_);
+    const auto sequence = control_.sequence.load(std::memory_order_relaxed);
+
+    control_.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    control_.targetScale.store(loopParameters.targetScale, std::memory_order_relaxed);
+    control_.timeStep.store(loopParameters.timeStep.count(), std::memory_order_relaxed);
+    control_.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SimulationRunner::pauseSimulation()
+{
+    setPaused(true);
+}
+
+void SimulationRunner::resumeSimulation()
+{
+    setPaused(false);
+}
+
+bool SimulationRunner::simulationIsPaused() const
+{
+    return control_.paused;
+}
+
+void SimulationRunner::stepSimulation()
+{
+    {
+        std::scoped_lock lock(controlMutex_);
+        ++control_.pendingSteps;
+    }
+    controlChanged_.notify_all();
+}
+
+void SimulationRunner::enqueueCommand(const SimulationCommand& command)
+{
+    std::scoped_lock lock(commandMutex_);
+    simulationFactory_.validateCommand(command);
+
+    if (simulationIsRunning())
+        enqueuedCommands_.push_back(command);
+    else
+        simulationFactory_.applyCommand(command);
 }
 
 void SimulationRunner::loop(std::stop_token stopToken)
@@ -123,71 +237,281 @@ void SimulationRunner::loop(std::stop_token stopToken)
     if (postStartCallback_)
         postStartCallback_();
 
-    auto simulationUpdateTime = 0ns;
+    // The reactions were shuffled with unseeded generators when the cell was built, the new order is active from the
+    // first update on
+    if (randomSeed_)
+    {
+        mathutils::seedRandomNumberGenerators(*randomSeed_);
+        simulationFactory_.recompileReactions();
+    }
+
+    PerformanceCounters counters;
+    counters.reset();
     auto simulationDuration = 0ns;
-    const auto simulationTimeStep = ch::nanoseconds{simulationConfig_.simulationTimeStep};
-    int updates = 0;
-    auto start = ch::steady_clock::now();
-    const auto scaled = simulationTimeStep / simulationConfig_.simulationTimeScale;
-    const auto realTimePerStep = ch::duration_cast<ch::steady_clock::duration>(scaled);
-    auto nextTick = start;
+    auto nextTick = counters.start;
+    auto batchStart = nextTick;
+    const bool useAdaptiveTimeStep = simulationConfig_.useAdaptiveTimeStep;
+
+    // Without pacing there is no target to keep up with
+    std::optional<QualityOfServiceController> qualityOfServiceController;
+    if (useScaleFromConfig_ && simulationConfig_.qualityOfService.enabled)
+        qualityOfServiceController.emplace(simulationConfig_.qualityOfService);
+    timeStepFactor_ = 1;
+
+    // Odd, so the first read always counts as a change
+    auto loopParametersSequence = std::numeric_limits<std::uint64_t>::max();
+    LoopParameters loopParameters{};
+    readLoopParameters(loopParameters, loopParametersSequence);
+
+    // Speeds are only measured during updates, so the first adaptive step has to be the smallest one
+    auto simulationTimeStep =
+        useAdaptiveTimeStep ? ch::nanoseconds{simulationConfig_.minTimeStep} : loopParameters.timeStep;
 
     while (!stopToken.stop_requested() && simulationDuration < simulationDuration_)
     {
+        if (control_.paused)
+        {
+            if (!waitWhilePaused(stopToken))
+                break;
+
+            // The pause must neither be caught up with nor lower the measured scale
+            counters.reset();
+            nextTick = batchStart = counters.start;
+        }
+
+        if (readLoopParameters(loopParameters, loopParametersSequence))
+        {
+            if (!useAdaptiveTimeStep)
+                simulationTimeStep = loopParameters.timeStep;
+
+            nextTick = batchStart = ch::steady_clock::now();
+        }
+
+        const auto workStart = ch::steady_clock::now();
+        {
+            std::scoped_lock lock(commandMutex_);
+            applyEnqueuedCommands();
+        }
+
+        // A time step enlarged by the quality of service controller mustn't overshoot the simulation duration either,
+        // and an adaptive one must stay within the limits it was chosen for
+        auto timeStep = simulationTimeStep;
+        if (timeStepFactor_ != 1)
+        {
+            timeStep = std::min(ch::duration_cast<ch::nanoseconds>(timeStepFactor_ * simulationTimeStep),
+                                simulationDuration_ - simulationDuration);
+            if (useAdaptiveTimeStep)
+                timeStep = std::min(timeStep, ch::nanoseconds{simulationConfig_.maxTimeStep});
+        }
+
         const auto updateStart = ch::steady_clock::now();
-        simulationFactory_.getCell().update(ch::duration<double>(simulationTimeStep).count());
+        simulationFactory_.getCell().update(ch::duration<double>(timeStep).count());
         const auto elapsed = ch::steady_clock::now() - updateStart;
-        simulationUpdateTime += elapsed;
-        simulationDuration += simulationTimeStep;
-        ++updates;
-
-        sendPerformanceData(start, updates, simulationUpdateTime, simulationDuration);
+        counters.simulationUpdateTime += elapsed;
+        counters.simulatedTime += timeStep;
+        simulationDuration += timeStep;
+        ++counters.updates;
 
         if (postUpdateCallback_)
-            postUpdateCallback_(simulationFactory_.getCell(), simulationTimeStep);
+            postUpdateCallback_(simulationFactory_.getCell(), timeStep);
+        counters.busyTime += ch::steady_clock::now() - workStart;
 
-        if (useScaleFromConfig_)
+        if (auto performanceData = collectPerformanceData(counters, simulationDuration, loopParameters.targetScale))
+            handlePerformanceData(*performanceData, qualityOfServiceController);
+
+        // Single steps while paused aren't paced
+        if (useScaleFromConfig_ && !control_.paused)
         {
-            nextTick += ch::duration_cast<ch::steady_clock::duration>(realTimePerStep);
-            std::this_thread::sleep_until(nextTick);
+            const auto scaled = timeStep / loopParameters.targetScale;
+            nextTick += ch::duration_cast<ch::steady_clock::duration>(scaled);
+
+            // Waiting after every update would mean thousands of short sleeps per second, each of them waking up late
+            const auto pacingInterval = ch::nanoseconds{control_.pacingInterval.load(std::memory_order_relaxed)};
+            if (nextTick - batchStart >= pacingInterval)
+            {
+                waitUntil(nextTick);
+                const auto now = ch::steady_clock::now();
+                counters.pacingError += now - nextTick;
+                ++counters.batches;
+
+                // A loop that fell behind by more than a batch continues from now instead of catching up in bursts
+                if (now - nextTick > pacingInterval)
+                    nextTick = now;
+                batchStart = nextTick;
+            }
         }
+
+        // The last adaptive step shouldn't overshoot the requested simulation duration
+        if (useAdaptiveTimeStep)
+            simulationTimeStep = std::min(calculateAdaptiveTimeStep(), simulationDuration_ - simulationDuration);
+    }
+
+    // The last period might be too short to judge, so it's only reported
+    const int fidelityLevel = qualityOfServiceController ? qualityOfServiceController->getFidelityLevel().level : 0;
+    auto performanceData =
+        collectPerformanceData(counters, simulationDuration, loopParameters.targetScale, Force{true});
+    if (performanceData && performanceDataCallback_)
+    {
+        performanceData->fidelityLevel = fidelityLevel;
+        performanceDataCallback_(*performanceData);
     }
 
-    sendPerformanceData(start, updates, simulationUpdateTime, simulationDuration, Force{true});
-    isRunning_ = false;
+    if (fidelityLevel > 0)
+        setFidelityLevel(QualityOfServiceController::FidelityLevel{});
+
+    {
+        std::scoped_lock lock(commandMutex_);
+        applyEnqueuedCommands();
+    }
 
+    // The callback reads the cell, so commands are still enqueued until it returns
     if (postStopCallback_)
         postStopCallback_();
+
+    {
+        // Commands enqueued after this are applied immediately, the ones before must not be left behind
+        std::scoped_lock lock(commandMutex_);
+        applyEnqueuedCommands();
+        isRunning_ = false;
+    }
 }
 
-void SimulationRunner::sendPerformanceData(ch::steady_clock::time_point& start, int& updates,
-                                           ch::nanoseconds& simulationUpdateTime,
-                                           const ch::nanoseconds& elapsedSimulationTime, Force force) const
+bool SimulationRunner::readLoopParameters(LoopParameters& loopParameters, std::uint64_t& sequence) const
 {
-    if (!performanceDataCallback_)
-        return;
+    while (true)
+    {
+        const auto before = control_.sequence.load(std::memory_order_acquire);
+        if (before == sequence)
+            return false;
 
-    const auto elapsed = ch::steady_clock::now() - start;
+        // A write is in progress, it only takes a few instructions
+        if (before % 2 == 1)
+            continue;
 
-    if (updates == 0 || (elapsed < 1s && !force.value))
-        return;
+        const LoopParameters read{.targetScale = control_.targetScale.load(std::memory_order_relaxed),
+                                  .timeStep = ch::nanoseconds{control_.timeStep.load(std::memory_order_relaxed)}};
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (control_.sequence.load(std::memory_order_relaxed) == before)
+        {
+            loopParameters = read;
+            sequence = before;
+            return true;
+        }
+    }
+}
+
+bool SimulationRunner::waitWhilePaused(std::stop_token stopToken)
+{
+    std::unique_lock lock(controlMutex_);
+    if (!controlChanged_.wait(lock, stopToken, [&]() { return !control_.paused || control_.pendingSteps > 0; }))
+        return false;
+
+    if (control_.paused)
+        --control_.pendingSteps;
+
+    return true;
+}
 
-    const double simulationTime =
-        updates * ch::duration<double>(ch::nanoseconds{simulationConfig_.simulationTimeStep}).count();
+void SimulationRunner::setPaused(bool paused)
+{
+    {
+        std::scoped_lock lock(controlMutex_);
+        control_.paused = paused;
+        control_.pendingSteps = 0;
+    }
+    controlChanged_.notify_all();
+}
+
+void SimulationRunner::applyEnqueuedCommands()
+{
+    // Validated when they were enqueued and the types can't change while the simulation is running
+    for (const auto& command : enqueuedCommands_)
+        simulationFactory_.applyCommand(command);
+
+    enqueuedCommands_.clear();
+}
+
+ch::nanoseconds SimulationRunner::calculateAdaptiveTimeStep()
+{
+    const auto minTimeStep = ch::nanoseconds{simulationConfig_.minTimeStep};
+    const auto maxTimeStep = ch::nanoseconds{simulationConfig_.maxTimeStep};
+    const double maxSpeedPerRadius = simulationFactory_.getCell().getMaxSpeedPerRadius();
+
+    if (maxSpeedPerRadius <= 0)
+        return maxTimeStep;
+
+    // Unimolecular reaction probabilities are given per second and converted with 1 - (1 - p)^dt, so they stay
+    // correct for a varying dt. With sub-steps, discs only move by a fraction of the step between collision checks
+    const auto substeps = simulationConfig_.collisionSubsteps;
+    const auto timeStep = ch::duration_cast<ch::nanoseconds>(
+        ch::duration<double>(substeps * simulationConfig_.maxDisplacementFraction / maxSpeedPerRadius));
+
+    return std::clamp(timeStep, minTimeStep, maxTimeStep);
+}
+
+std::optional<SimulationRunner::PerformanceData>
+SimulationRunner::collectPerformanceData(PerformanceCounters& counters, const ch::nanoseconds& elapsedSimulationTime,
+                                         double targetScale, Force force) const
+{
+    const auto elapsed = ch::steady_clock::now() - counters.start;
+
+    if (counters.updates == 0 || (elapsed < 1s && !force.value))
+        return std::nullopt;
+
+    const double simulationTime = ch::duration<double>(counters.simulatedTime).count();
     const double elapsedSeconds = ch::duration<double>(elapsed).count();
     const double actualScale = simulationTime / elapsedSeconds;
-    const auto timePerWholeUpdate = elapsed / updates;
-    const auto timePerSimulationUpdate = simulationUpdateTime / updates;
-
-    performanceDataCallback_(PerformanceData{.targetScale = simulationConfig_.simulationTimeScale,
-                                             .actualScale = actualScale,
-                                             .timePerWholeUpdate = timePerWholeUpdate,
-                                             .timePerSimulationUpdate = timePerSimulationUpdate,
-                                             .elapsedSimulationTime = elapsedSimulationTime});
-
-    start = ch::steady_clock::now();
-    updates = 0;
-    simulationUpdateTime = 0s;
+    const auto timePerWholeUpdate = elapsed / counters.updates;
+    const auto timePerSimulationUpdate = counters.simulationUpdateTime / counters.updates;
+    const auto pacingError = counters.batches > 0 ? counters.pacingError / counters.batches : 0ns;
+    const double updatesPerBatch =
+        counters.batches > 0 ? static_cast<double>(counters.updates) / counters.batches : 0.0;
+
+    PerformanceData performanceData{.targetScale = targetScale,
+                                    .actualScale = actualScale,
+                                    .timePerWholeUpdate = timePerWholeUpdate,
+                                    .timePerSimulationUpdate = timePerSimulationUpdate,
+                                    .elapsedSimulationTime = elapsedSimulationTime,
+                                    .timeStep = counters.simulatedTime / counters.updates,
+                                    .pacingError = pacingError,
+                                    .updatesPerBatch = updatesPerBatch,
+                                    .load = ch::duration<double>(counters.busyTime).count() / elapsedSeconds,
+                                    .fidelityLevel = 0};
+
+    counters.reset();
+
+    return performanceData;
+}
+
+void SimulationRunner::handlePerformanceData(PerformanceData performanceData,
+                                             std::optional<QualityOfServiceController>& qualityOfServiceController)
+{
+    if (qualityOfServiceController)
+    {
+        if (qualityOfServiceController->update(performanceData.targetScale, performanceData.actualScale,
+                                               performanceData.load))
+            setFidelityLevel(qualityOfServiceController->getFidelityLevel());
+
+        performanceData.fidelityLevel = qualityOfServiceController->getFidelityLevel().level;
+    }
+
+    if (performanceDataCallback_)
+        performanceDataCallback_(performanceData);
+}
+
+void SimulationRunner::setFidelityLevel(const QualityOfServiceController::FidelityLevel& fidelityLevel)
+{
+    std::cout << "Quality of service: Switching to " << toString(fidelityLevel) << std::endl;
+
+    timeStepFactor_ = fidelityLevel.timeStepFactor;
+    if (fidelityLevelCallback_)
+        fidelityLevelCallback_(fidelityLevel);
+}
+
+void SimulationRunner::PerformanceCounters::reset()
+{
+    *this = PerformanceCounters{.start = ch::steady_clock::now()};
 }
 
 } // namespace cell
\ No newline at end of file
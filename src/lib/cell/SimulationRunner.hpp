@@ -1,13 +1,20 @@
 #ifndef F1160089_C2A5_45FA_AC16_370C293275DE_HPP
 #define F1160089_C2A5_45FA_AC16_370C293275DE_HPP
 
+#include "QualityOfServiceController.hpp"
+#include "SimulationCommand.hpp"
 #include "SimulationConfig.hpp"
 #include "SimulationFactory.hpp"
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
 namespace fs = std::filesystem;
 namespace ch = std::chrono;
@@ -30,6 +37,33 @@ public:
         ch::nanoseconds timePerWholeUpdate;
         ch::nanoseconds timePerSimulationUpdate;
         ch::nanoseconds elapsedSimulationTime;
+
+        /**
+         * @brief Average time step of the updates since the last report. Only differs from the configured time step if
+         * adaptive time stepping is enabled
+         */
+        ch::nanoseconds timeStep;
+
+        /**
+         * @brief Average deviation of the wake-up times from the scheduled ones when pacing with the target scale.
+         * Positive if the loop woke up late or couldn't keep up, 0 if it doesn't pace
+         */
+        ch::nanoseconds pacingError;
+
+        /**
+         * @brief Average number of updates run between 2 waits when pacing with the target scale
+         */
+        double updatesPerBatch;
+
+        /**
+         * @brief Fraction of the real time spent on updates, commands and callbacks instead of waiting
+         */
+        double load;
+
+        /**
+         * @brief Current level of the quality of service controller, 0 (full fidelity) if it's disabled
+         */
+        int fidelityLevel;
     };
 
     struct LoopParameters
@@ -41,6 +75,17 @@ public:
 public:
     void useConfigFile(const fs::path& configFile);
     void useConfig(const SimulationConfig& simulationConfig);
+
+    /**
+     * @brief Continues from a deep copy of the cell of `source` instead of building a new one, see
+     * SimulationFactory::buildReplicaOf(). `source` must not be running
+     */
+    void useReplicaOf(const SimulationRunner& source, const SimulationConfig& simulationConfig);
+
+    /**
+     * @brief Seeds the random number generators of the simulation thread whenever the simulation is started
+     */
+    void setRandomSeed(std::optional<std::uint64_t> randomSeed);
     void setSimulationDuration(const ch::nanoseconds& simulationDuration);
     void runSimulation();
     void waitForSimulationToFinish();
@@ -50,16 +95,125 @@ public:
     void setPostUpdateCallback(std::function<void(Cell&, const ch::nanoseconds&)> callback);
     void setPostStartCallback(std::function<void()> callback);
     void setPostStopCallback(std::function<void()> callback);
+
+    /**
+     * @brief Called from the simulation thread whenever the quality of service controller changes the fidelity level,
+     * and with full fidelity when a simulation that lowered it stops. The time step is adjusted by the runner, the
+     * other levers are up to the callback
+     */
+    void setFidelityLevelCallback(std::function<void(const QualityOfServiceController::FidelityLevel&)> callback);
     SimulationContext getSimulationContext() const;
+
+    /**
+     * @brief Only safe to use while the simulation isn't running or from within the callbacks
+     */
+    Cell& getCell();
     const SimulationConfig& getSimulationConfig() const;
+
+    /**
+     * @brief See SimulationFactory::createCheckpoint(). The simulation must not be running
+     */
+    SimulationConfig createCheckpoint() const;
     void setUseScaleFromConfig(bool value);
     bool simulationIsRunning() const;
+
+    /**
+     * @brief When pacing with the target scale, updates are run in batches that take this long in real time and the
+     * loop waits once per batch instead of after every update. Usually the frame interval of the display. Thread-safe
+     */
+    void setPacingInterval(const ch::nanoseconds& pacingInterval);
+
+    /**
+     * @brief Thread-safe. A running loop picks the new parameters up before its next update and paces the following
+     * updates from there on, without catching up with the old parameters. The parameters of the config are only used
+     * until this is called for the first time after the config was set
+     */
     void updateLoopParameters(LoopParameters loopParameters);
 
+    /**
+     * @brief The loop finishes its current update and then waits until the simulation is resumed or stopped.
+     * Thread-safe, starting the simulation again resumes it as well
+     */
+    void pauseSimulation();
+    void resumeSimulation();
+    bool simulationIsPaused() const;
+
+    /**
+     * @brief Lets a paused simulation run a single update. Thread-safe
+     */
+    void stepSimulation();
+
+    /**
+     * @brief Edits the cell in place instead of rebuilding it. The command is validated right away and throws if it's
+     * invalid. It is applied before the next update if the simulation is running, otherwise immediately. Thread-safe
+     */
+    void enqueueCommand(const SimulationCommand& command);
+
+private:
+    /**
+     * @brief Written by any thread under controlMutex_, read by the loop once per iteration without locking. Target
+     * scale and time step are read through a sequence lock, so the loop never combines a new scale with an old step
+     */
+    struct ControlBlock
+    {
+        std::atomic<std::uint64_t> sequence = 0; // Odd while the loop parameters are being written
+        std::atomic<double> targetScale = 1;
+        std::atomic<long long> timeStep = 0;
+        std::atomic<bool> paused = false;
+        std::atomic<long long> pacingInterval = ch::nanoseconds{ch::milliseconds{16}}.count();
+        int pendingSteps = 0;
+    };
+
+    /**
+     * @brief Accumulated since the last performance report
+     */
+    struct PerformanceCounters
+    {
+        ch::steady_clock::time_point start;
+        int updates = 0;
+        ch::nanoseconds simulationUpdateTime{0};
+        ch::nanoseconds simulatedTime{0};
+        ch::nanoseconds pacingError{0};
+        int batches = 0;
+        ch::nanoseconds busyTime{0};
+
+        void reset();
+    };
+
 private:
     void loop(std::stop_token stopToken);
-    void sendPerformanceData(ch::steady_clock::time_point& start, int& updates, ch::nanoseconds& simulationUpdateTime,
-                             const ch::nanoseconds& elapsedSimulationTime, Force force = {}) const;
+
+    /**
+     * @param sequence The sequence number of the parameters the loop currently uses, updated if they changed
+     * @returns true if the parameters changed since `sequence` and were written to `loopParameters`
+     */
+    bool readLoopParameters(LoopParameters& loopParameters, std::uint64_t& sequence) const;
+
+    /**
+     * @returns false if the simulation was stopped while paused
+     */
+    bool waitWhilePaused(std::stop_token stopToken);
+    void setPaused(bool paused);
+
+    /**
+     * @brief commandMutex_ must be locked
+     */
+    void applyEnqueuedCommands();
+    ch::nanoseconds calculateAdaptiveTimeStep();
+
+    /**
+     * @returns The performance data of the current measurement period and resets the counters if the period is over
+     */
+    std::optional<PerformanceData> collectPerformanceData(PerformanceCounters& counters,
+                                                          const ch::nanoseconds& elapsedSimulationTime,
+                                                          double targetScale, Force force = {}) const;
+
+    /**
+     * @brief Lets the controller react to the measured performance, if there is one, and sends the data
+     */
+    void handlePerformanceData(PerformanceData performanceData,
+                               std::optional<QualityOfServiceController>& qualityOfServiceController);
+    void setFidelityLevel(const QualityOfServiceController::FidelityLevel& fidelityLevel);
 
 private:
     SimulationFactory simulationFactory_;
@@ -70,9 +224,17 @@ private:
     std::function<void(Cell&)> postBuildCallback_;
     std::function<void()> postStartCallback_;
     std::function<void()> postStopCallback_;
+    std::function<void(const QualityOfServiceController::FidelityLevel&)> fidelityLevelCallback_;
     ch::nanoseconds simulationDuration_ = ch::nanoseconds::max();
     bool useScaleFromConfig_ = false;
+    std::optional<std::uint64_t> randomSeed_;
+    double timeStepFactor_ = 1; // Only used by the simulation thread
     std::atomic<bool> isRunning_ = false;
+    std::mutex commandMutex_;
+    std::vector<SimulationCommand> enqueuedCommands_;
+    ControlBlock control_;
+    std::mutex controlMutex_;
+    std::condition_variable_any controlChanged_;
 };
 
 } // namespace cell
@@ -0,0 +1,79 @@
+#ifndef A7135D52_1A6E_49D2_A08D_F957F9D1BC2C_HPP
+#define A7135D52_1A6E_49D2_A08D_F957F9D1BC2C_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace cell
+{
+
+/**
+ * @brief Lock-free exchange of the latest value between exactly one producer and one consumer thread. The producer
+ * fills the write buffer and publishes it, the consumer picks up the most recently published buffer. Neither side ever
+ * waits for the other, values the consumer didn't pick up in time are simply overwritten. Buffers are reused, so a
+ * value type that keeps its capacity (like a vector) doesn't allocate once it has grown large enough
+ */
+template <typename T> class TripleBuffer
+{
+public:
+    /**
+     * @brief Producer side: The buffer to write the next value into
+     */
+    T& getWriteBuffer();
+
+    /**
+     * @brief Producer side: Makes the write buffer available to the consumer and switches to a free buffer
+     */
+    void publish();
+
+    /**
+     * @brief Consumer side: Switches to the most recently published buffer, if there is one
+     * @returns true if a new value was published since the last call
+     */
+    bool update();
+
+    /**
+     * @brief Consumer side: The value picked up by the last call to `update()`
+     */
+    const T& getReadBuffer() const;
+
+private:
+    // The middle index is shared between both threads, the dirty bit marks it as published and not yet picked up
+    static constexpr std::uint8_t IndexMask = 0b011;
+    static constexpr std::uint8_t DirtyBit = 0b100;
+
+    std::array<T, 3> buffers_;
+    std::uint8_t writeIndex_ = 0;
+    std::atomic<std::uint8_t> middle_ = 1;
+    std::uint8_t readIndex_ = 2;
+};
+
+template <typename T> inline T& TripleBuffer<T>::getWriteBuffer()
+{
+    return buffers_[writeIndex_];
+}
+
+template <typename T> inline void TripleBuffer<T>::publish()
+{
+    writeIndex_ = middle_.exchange(writeIndex_ | DirtyBit, std::memory_order_acq_rel) & IndexMask;
+}
+
+template <typename T> inline bool TripleBuffer<T>::update()
+{
+    if ((middle_.load(std::memory_order_relaxed) & DirtyBit) == 0)
+        return false;
+
+    readIndex_ = middle_.exchange(readIndex_, std::memory_order_acq_rel) & IndexMask;
+
+    return true;
+}
+
+template <typename T> inline const T& TripleBuffer<T>::getReadBuffer() const
+{
+    return buffers_[readIndex_];
+}
+
+} // namespace cell
+
+#endif /* A7135D52_1A6E_49D2_A08D_F957F9D1BC2C_HPP */
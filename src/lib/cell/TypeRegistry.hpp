@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace cell
@@ -27,6 +28,12 @@ public:
 
     KeyType getIDFor(const std::string& name) const;
     const ValueType& getByID(KeyType ID) const;
+
+    /**
+     * @brief For changing values in place. Renaming them this way isn't supported, the name map isn't updated
+     */
+    ValueType& getByID(KeyType ID);
+
     std::vector<KeyType> getIDs() const;
 
 private:
@@ -81,6 +88,11 @@ template <typename ValueType> inline const ValueType& TypeRegistry<ValueType>::g
     return values_[ID];
 }
 
+template <typename ValueType> inline ValueType& TypeRegistry<ValueType>::getByID(KeyType ID)
+{
+    return const_cast<ValueType&>(std::as_const(*this).getByID(ID));
+}
+
 template <typename ValueType>
 inline std::vector<typename TypeRegistry<ValueType>::KeyType> TypeRegistry<ValueType>::getIDs() const
 {
@@ -0,0 +1,89 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+namespace cell
+{
+
+WorkerPool::WorkerPool(std::size_t threadCount)
+{
+    for (std::size_t i = 1; i < threadCount; ++i)
+        workers_.emplace_back([this](std::stop_token stopToken) { work(stopToken); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    // Workers need to be joined while the synchronization members still exist
+    workers_.clear();
+}
+
+std::size_t WorkerPool::getThreadCount() const
+{
+    return workers_.size() + 1;
+}
+
+void WorkerPool::parallelFor(std::size_t count, std::size_t minChunkSize,
+                             const std::function<void(std::size_t, std::size_t)>& body)
+{
+    const auto chunkSize = std::max({minChunkSize, (count + workers_.size()) / getThreadCount(), std::size_t{1}});
+    if (chunkSize >= count)
+    {
+        if (count > 0)
+            body(0, count);
+
+        return;
+    }
+
+    std::scoped_lock callLock(callMutex_);
+    {
+        std::scoped_lock lock(mutex_);
+        body_ = &body;
+        count_ = count;
+        chunkSize_ = chunkSize;
+        nextChunk_ = 0;
+        busyWorkers_ = workers_.size();
+        ++generation_;
+    }
+
+    jobAvailable_.notify_all();
+    processChunks();
+
+    std::unique_lock lock(mutex_);
+    jobDone_.wait(lock, [&] { return busyWorkers_ == 0; });
+}
+
+void WorkerPool::work(std::stop_token stopToken)
+{
+    std::size_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            if (!jobAvailable_.wait(lock, stopToken, [&] { return generation_ != generation; }))
+                return;
+
+            generation = generation_;
+        }
+
+        processChunks();
+
+        std::scoped_lock lock(mutex_);
+        if (--busyWorkers_ == 0)
+            jobDone_.notify_one();
+    }
+}
+
+void WorkerPool::processChunks()
+{
+    while (true)
+    {
+        const auto begin = nextChunk_.fetch_add(1) * chunkSize_;
+        if (begin >= count_)
+            return;
+
+        (*body_)(begin, std::min(begin + chunkSize_, count_));
+    }
+}
+
+} // namespace cell
@@ -0,0 +1,64 @@
+#ifndef A702827A_9788_4223_A365_623BDEE29133_HPP
+#define A702827A_9788_4223_A365_623BDEE29133_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cell
+{
+
+/**
+ * @brief Fixed set of threads for splitting loops over discs within a single simulation step. The calling thread takes
+ * part in the work, so a pool with a thread count of 1 doesn't start any threads and runs everything in place.
+ * Calls from several threads are serialized
+ */
+class WorkerPool
+{
+public:
+    /**
+     * @param threadCount Total number of threads working on a loop, including the calling thread
+     */
+    explicit WorkerPool(std::size_t threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::size_t getThreadCount() const;
+
+    /**
+     * @brief Calls body(begin, end) for consecutive chunks covering [0, count) and returns when all chunks are done.
+     * Chunks have at least minChunkSize elements, so small loops run on the calling thread only
+     */
+    void parallelFor(std::size_t count, std::size_t minChunkSize,
+                     const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+    void work(std::stop_token stopToken);
+    void processChunks();
+
+private:
+    std::vector<std::jthread> workers_;
+
+    std::mutex callMutex_;
+    std::mutex mutex_;
+    std::condition_variable_any jobAvailable_;
+    std::condition_variable jobDone_;
+
+    // The current job, guarded by mutex_ except for the chunk counter
+    const std::function<void(std::size_t, std::size_t)>* body_ = nullptr;
+    std::size_t count_ = 0;
+    std::size_t chunkSize_ = 0;
+    std::atomic<std::size_t> nextChunk_ = 0;
+    std::size_t generation_ = 0;
+    std::size_t busyWorkers_ = 0;
+};
+
+} // namespace cell
+
+#endif /* A702827A_9788_4223_A365_623BDEE29133_HPP */
@@ -34,6 +34,10 @@ MainWindow::MainWindow(QWidget* parent)
             utility::safeSlot(this, [this]() { startSimulation(); }));
     connect(ui->simulationControlWidget, &SimulationControlWidget::simulationStopClicked, this,
             &MainWindow::stopSimulation);
+    connect(ui->simulationControlWidget, &SimulationControlWidget::simulationPauseToggled, simulation_.get(),
+            &Simulation::setPaused);
+    connect(ui->simulationControlWidget, &SimulationControlWidget::simulationStepClicked, simulation_.get(),
+            &Simulation::step);
 
     connect(ui->simulationControlWidget, &SimulationControlWidget::simulationResetTriggered, this,
             &MainWindow::resetSimulation);
@@ -61,6 +65,8 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(simulationConfigUpdater_, &SimulationConfigUpdater::simulationResetRequired, this,
             &MainWindow::resetSimulation);
+    connect(simulationConfigUpdater_, &SimulationConfigUpdater::reactionsChanged, simulation_.get(),
+            &Simulation::setReactions);
     connect(simulationConfigUpdater_, &SimulationConfigUpdater::loopParameters, simulation_.get(),
             &Simulation::updateLoopParameters);
 
@@ -76,7 +82,6 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(simulation_.get(), &Simulation::drawFrameImmediately, ui->simulationWidget,
             &SimulationWidget::renderFrameImmediately);
-    connect(simulation_.get(), &Simulation::frame, ui->simulationWidget, &SimulationWidget::queueFrameForRendering);
     connect(simulation_.get(), &Simulation::performanceData, ui->simulationInfoWidget,
             &SimulationInfoWidget::setPerformanceData);
     ui->simulationWidget->injectDependencies(simulationConfigUpdater_, simulation_.get());
@@ -15,10 +15,16 @@ Simulation::Simulation(QObject* parent)
     simulationRunner_.setPostStopCallback(
         [&]()
         {
+            // Frames are only published once per render interval, so the final state might not have been published
+            if (simulationRecorder_)
+                simulationRecorder_->publishFrame(simulationRunner_.getCell());
+
             emit stopped();
             emitLastFrame();
         });
     simulationRunner_.setUseScaleFromConfig(true);
+
+    connect(&simulationConfigUpdater_, &SimulationConfigUpdater::fpsChanged, this, &Simulation::setFrameInterval);
 }
 
 void Simulation::start()
@@ -36,6 +42,19 @@ bool Simulation::isRunning() const
     return simulationRunner_.simulationIsRunning();
 }
 
+void Simulation::setPaused(bool paused)
+{
+    if (paused)
+        simulationRunner_.pauseSimulation();
+    else
+        simulationRunner_.resumeSimulation();
+}
+
+void Simulation::step()
+{
+    simulationRunner_.stepSimulation();
+}
+
 void Simulation::reinitialize()
 {
     simulationRunner_.setPostBuildCallback({});
@@ -54,7 +73,15 @@ void Simulation::emitLastFrame()
     if (!simulationRecorder_)
         return;
 
-    emit drawFrameImmediately(simulationRecorder_->getLastFrame());
+    emit drawFrameImmediately();
+}
+
+const Frame* Simulation::getLatestFrame()
+{
+    if (!simulationRecorder_)
+        return nullptr;
+
+    return &simulationRecorder_->getLatestFrame();
 }
 
 SimulationConfigUpdater& Simulation::getSimulationConfigUpdater()
@@ -75,6 +102,14 @@ const cell::SimulationRecorder& Simulation::getSimulationRecorder() const
     return *simulationRecorder_;
 }
 
+const cell::DownsamplingDataPointSink& Simulation::getDataPointHistory() const
+{
+    if (!dataPointHistory_)
+        throw ExceptionWithLocation("Simulation recorder has not yet been initialized");
+
+    return *dataPointHistory_;
+}
+
 cell::SimulationContext Simulation::getSimulationContext()
 {
     return simulationRunner_.getSimulationContext();
@@ -90,6 +125,27 @@ void Simulation::waitForSimulationToFinish()
     simulationRunner_.waitForSimulationToFinish();
 }
 
+void Simulation::applyCommand(const cell::SimulationCommand& command)
+{
+    simulationRunner_.enqueueCommand(command);
+
+    // A running simulation publishes the change with its next frame
+    if (!isRunning() && simulationRecorder_)
+    {
+        simulationRecorder_->publishFrame(simulationRunner_.getCell());
+        emitLastFrame();
+    }
+}
+
+void Simulation::setReactions(const std::vector<cell::config::Reaction>& reactions)
+{
+    // Nothing to swap before the first build, the reactions are part of the config then
+    if (!simulationRecorder_)
+        return;
+
+    applyCommand(cell::command::SetReactions{reactions});
+}
+
 void Simulation::initializeSimulationRecorder()
 {
     simulationRecorder_ =
@@ -97,7 +153,13 @@ void Simulation::initializeSimulationRecorder()
                                                    simulationRunner_.getSimulationConfig().mostProbableSpeed);
     simulationRecorder_->setStorageInterval(ch::milliseconds{10});
 
+    auto dataPointHistory =
+        std::make_unique<cell::DownsamplingDataPointSink>(simulationRecorder_->getStorageInterval());
+    dataPointHistory_ = dataPointHistory.get();
+    simulationRecorder_->setDataPointSink(std::move(dataPointHistory));
+
     simulationRecorder_->setRecordLastFrame(true);
+    setFrameInterval(simulationConfigUpdater_.getFPS());
     simulationRunner_.setPerformanceDataCallback([&](auto data) { emit performanceData(data); });
     simulationRunner_.setPostBuildCallback(
         [&](cell::Cell& cell)
@@ -107,10 +169,22 @@ void Simulation::initializeSimulationRecorder()
         });
     simulationRunner_.setPostUpdateCallback(
         [&](cell::Cell& cell, const ch::nanoseconds& elapsedTime)
+        { simulationRecorder_->processSimulationData(cell, elapsedTime); });
+    simulationRunner_.setFidelityLevelCallback(
+        [&](const cell::QualityOfServiceController::FidelityLevel& fidelityLevel)
         {
-            simulationRecorder_->processSimulationData(cell, elapsedTime);
-            emit frame(simulationRecorder_->getLastFrame());
+            simulationRecorder_->setFrameIntervalFactor(fidelityLevel.frameIntervalFactor);
+            simulationRecorder_->setSamplingStride(fidelityLevel.recordingStride);
         });
     simulationRecorder_->setNewDataPointCallback([&](const cell::DataPoint& dataPoint)
                                                  { emit this->dataPoint(dataPoint); });
 }
+
+void Simulation::setFrameInterval(int FPS)
+{
+    if (!simulationRecorder_ || FPS <= 0)
+        return;
+
+    simulationRecorder_->setFrameInterval(ch::nanoseconds{ch::seconds{1}} / FPS);
+    simulationRunner_.setPacingInterval(ch::nanoseconds{ch::seconds{1}} / FPS);
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef C79C95D4_043A_4803_8C77_D97B81275A0C_HPP
 #define C79C95D4_043A_4803_8C77_D97B81275A0C_HPP
 
+#include "cell/DownsamplingDataPointSink.hpp"
 #include "cell/SimulationConfig.hpp"
 #include "cell/SimulationRecorder.hpp"
 #include "cell/SimulationRunner.hpp"
@@ -28,25 +29,48 @@ public:
     void start();
     void stop();
     bool isRunning() const;
+    void setPaused(bool paused);
+
+    /**
+     * @brief Runs a single update while the simulation is paused
+     */
+    void step();
     void reinitialize();
     void loadSettingsFromJson(const fs::path& settingsPath);
     void emitLastFrame();
 
+    /**
+     * @brief The most recently published frame of the simulation, nullptr before the simulation was initialized. Must
+     * only be called from the GUI thread
+     */
+    const Frame* getLatestFrame();
+
     SimulationConfigUpdater& getSimulationConfigUpdater();
     const cell::SimulationConfig& getSimulationConfig() const;
     const cell::SimulationRecorder& getSimulationRecorder() const;
+
+    /**
+     * @brief The recorded history, pre-aggregated at multiple resolutions for plotting
+     */
+    const cell::DownsamplingDataPointSink& getDataPointHistory() const;
     cell::SimulationContext getSimulationContext();
     void updateLoopParameters(const cell::SimulationRunner::LoopParameters& loopParameters);
     void waitForSimulationToFinish();
 
+    /**
+     * @brief Edits the cell without resetting the simulation, see cell::SimulationRunner::enqueueCommand()
+     */
+    void applyCommand(const cell::SimulationCommand& command);
+    void setReactions(const std::vector<cell::config::Reaction>& reactions);
+
 private:
     void initializeSimulationRecorder();
+    void setFrameInterval(int FPS);
 
 signals:
     void started();
     void stopped();
-    void drawFrameImmediately(Frame frame);
-    void frame(Frame frame);
+    void drawFrameImmediately();
     void performanceData(const cell::SimulationRunner::PerformanceData& performanceData);
     void dataPoint(const cell::DataPoint& dataPoint);
     void simulationContextChanged(cell::SimulationContext simulationContext);
@@ -54,6 +78,7 @@ signals:
 private:
     cell::SimulationRunner simulationRunner_;
     std::unique_ptr<cell::SimulationRecorder> simulationRecorder_;
+    cell::DownsamplingDataPointSink* dataPointHistory_ = nullptr;
     SimulationConfigUpdater simulationConfigUpdater_;
 };
 
@@ -27,8 +27,17 @@ void SimulationConfigUpdater::setSimulationConfig(const cell::SimulationConfig&
     emit loopParameters({.targetScale = simulationConfig.simulationTimeScale,
                          .timeStep = ch::nanoseconds{simulationConfig.simulationTimeStep}});
 
-    if (oldConfig != simulationConfig && emitSimulationReset.value)
-        emit simulationResetRequired();
+    // Reactions can be swapped in the running simulation as long as the types they refer to stay the same
+    const bool reactionsDiffer = oldConfig.reactions != simulationConfig.reactions;
+    oldConfig.reactions = simulationConfig.reactions;
+
+    if (oldConfig != simulationConfig)
+    {
+        if (emitSimulationReset.value)
+            emit simulationResetRequired();
+    }
+    else if (reactionsDiffer)
+        emit reactionsChanged(simulationConfig.reactions);
 }
 
 const std::map<std::string, sf::Color>& SimulationConfigUpdater::getDiscTypeColorMap() const
@@ -124,8 +133,8 @@ void SimulationConfigUpdater::removeMembraneTypes(cell::SimulationConfig& config
 
 void SimulationConfigUpdater::testConfig(const cell::SimulationConfig& simulationConfig) const
 {
-    cell::SimulationFactory simulationFactory;
-    simulationFactory.buildSimulationFromConfig(simulationConfig);
+    // The simulation is built (and populated) once the reset is processed, here only the checks are needed
+    cell::SimulationFactory::validateSimulationConfig(simulationConfig);
 }
 
 void SimulationConfigUpdater::setSimulationConfigWithoutSignals(const cell::SimulationConfig& simulationConfig)
@@ -37,6 +37,11 @@ public:
 
 signals:
     void simulationResetRequired();
+
+    /**
+     * @brief Emitted instead of simulationResetRequired() if nothing but the reactions changed
+     */
+    void reactionsChanged(const std::vector<cell::config::Reaction>& reactions);
     void loopParameters(const cell::SimulationRunner::LoopParameters& loopParameters);
     void fpsChanged(int FPS);
 
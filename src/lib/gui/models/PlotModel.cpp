@@ -111,22 +111,13 @@ void PlotModel::setLinePlot()
     std::vector<std::unordered_map<DiscTypeID, double>> fullPlotData;
     std::vector<double> x;
     double currentX = 0;
-    const auto& dataPoints = simulation_->getSimulationRecorder().getDataPoints();
-    auto dataPoint = createDataPoint();
-
-    const std::size_t expectedSize =
-        static_cast<std::size_t>(
-            static_cast<double>(dataPoints.size()) *
-            ch::duration<double>(simulation_->getSimulationRecorder().getStorageInterval()).count() /
-            plotTimeInterval_.count()) +
-        1;
-    fullPlotData.reserve(expectedSize);
-    x.reserve(expectedSize);
-
-    const auto addDataPoint = [&](const DataPoint& dataPoint)
-    {
-        const auto& activeMap = getActiveMap(dataPoint);
 
+    const auto& dataPointHistory = simulation_->getDataPointHistory();
+    const auto level = dataPointHistory.getCoarsestLevelFor(getPlotTimeIntervalNanoseconds());
+    const auto levelInterval = ch::duration<double>(dataPointHistory.getLevelInterval(level)).count();
+
+    const auto addActiveMap = [&](const std::unordered_map<DiscTypeID, double>& activeMap)
+    {
         if (plotSum_)
         {
             const auto sum =
@@ -135,26 +126,47 @@ void PlotModel::setLinePlot()
             fullPlotData.push_back({{0, sum}});
         }
         else
-            fullPlotData.push_back(getActiveMap(dataPoint));
+            fullPlotData.push_back(activeMap);
     };
 
-    addDataPoint(dataPoints.front());
-    x.push_back(0);
-
-    for (std::size_t i = 1; i < dataPoints.size(); ++i)
-    {
-        // TODO This adds everything, but we only need the current plot category
-        dataPoint.add(dataPoints[i]);
-
-        if (dataPoint.getData().elapsedTime < plotTimeInterval_)
-            continue;
-
-        dataPoint.average(cell::NormalizeCollisionCounts{true});
-        addDataPoint(dataPoint);
-        currentX += ch::duration<double>(dataPoint.getData().elapsedTime).count();
-        x.push_back(currentX);
-        dataPoint.clear();
-    }
+    dataPointHistory.readLevel(
+        level,
+        [&](const std::deque<DataPoint>& dataPoints)
+        {
+            const std::size_t expectedSize =
+                static_cast<std::size_t>(static_cast<double>(dataPoints.size()) * levelInterval /
+                                         plotTimeInterval_.count()) +
+                1;
+            fullPlotData.reserve(expectedSize);
+            x.reserve(expectedSize);
+
+            addActiveMap(getActiveMap(dataPoints.front()));
+            x.push_back(0);
+
+            // Only the maps of the current plot category are accumulated, the rest of the data points is skipped
+            std::unordered_map<DiscTypeID, double> activeMap;
+            ch::nanoseconds elapsedTime{0};
+            int count = 0;
+
+            for (std::size_t i = 1; i < dataPoints.size(); ++i)
+            {
+                cell::addMapToMap(activeMap, getActiveMap(dataPoints[i]));
+                elapsedTime += dataPoints[i].getData().elapsedTime;
+                ++count;
+
+                if (elapsedTime < plotTimeInterval_)
+                    continue;
+
+                averageActiveMap(activeMap, elapsedTime, count);
+                addActiveMap(activeMap);
+                currentX += ch::duration<double>(elapsedTime).count();
+                x.push_back(currentX);
+
+                activeMap.clear();
+                elapsedTime = ch::nanoseconds{0};
+                count = 0;
+            }
+        });
     currentX_ = currentX;
 
     emit setPlot(PlotWidget::LinePlotParams{
@@ -164,21 +176,30 @@ void PlotModel::setLinePlot()
 void PlotModel::setHistogramPlot()
 {
     cell::Histogram histogram;
-    const auto storageTime = simulation_->getSimulationRecorder().getStorageInterval();
-    const auto& dataPoints = simulation_->getSimulationRecorder().getDataPoints();
-    const int requiredDataPoints = std::max(1, static_cast<int>(std::ceil(plotTimeInterval_ / storageTime)));
-
-    if (static_cast<int>(dataPoints.size()) < requiredDataPoints)
-        histogram = getVelocityHistogramFromDataPoint(dataPoints.front(), CalculateSum{plotSum_});
-    else
-    {
-        histogram = getVelocityHistogramFromDataPoint(dataPoints.back(), CalculateSum{plotSum_});
-
-        for (int i = 1; i < requiredDataPoints; ++i)
-            histogram += getVelocityHistogramFromDataPoint(dataPoints[i], CalculateSum{plotSum_});
-
-        histogram /= requiredDataPoints;
-    }
+    const auto& dataPointHistory = simulation_->getDataPointHistory();
+    const auto level = dataPointHistory.getCoarsestLevelFor(getPlotTimeIntervalNanoseconds());
+    const auto levelInterval = dataPointHistory.getLevelInterval(level);
+    const int requiredDataPoints = std::max(1, static_cast<int>(std::ceil(plotTimeInterval_ / levelInterval)));
+
+    dataPointHistory.readLevel(
+        level,
+        [&](const std::deque<DataPoint>& dataPoints)
+        {
+            if (static_cast<int>(dataPoints.size()) < requiredDataPoints)
+            {
+                histogram = getVelocityHistogramFromDataPoint(dataPoints.front(), CalculateSum{plotSum_});
+                return;
+            }
+
+            // Average over the most recent plot time interval
+            auto velocityHistogram = getVelocityHistogram(dataPoints.back());
+            for (int i = 1; i < requiredDataPoints; ++i)
+                velocityHistogram += getVelocityHistogram(dataPoints[dataPoints.size() - 1 - i]);
+
+            velocityHistogram /= requiredDataPoints;
+            histogram = reduceVelocityHistogram(velocityHistogram.toHistogram(), CalculateSum{plotSum_});
+        },
+        static_cast<std::size_t>(requiredDataPoints));
 
     emit setPlot(PlotWidget::HistogramParams{.labels = labels_, .colors = colors_, .histogram = histogram});
 }
@@ -186,27 +207,46 @@ void PlotModel::setHistogramPlot()
 void PlotModel::setColorMapPlot()
 {
     std::vector<cell::Histogram> histograms;
-    const auto& simulationRecorder = simulation_->getSimulationRecorder();
-    const auto& dataPoints = simulationRecorder.getDataPoints();
-    histograms.reserve(dataPoints.size());
-
-    auto dataPoint = createDataPoint();
-
-    for (const auto& p : dataPoints)
-    {
-        dataPoint.add(p);
-
-        if (dataPoint.getData().elapsedTime < plotTimeInterval_)
-            continue;
-
-        dataPoint.average();
-        histograms.push_back(getVelocityHistogramFromDataPoint(dataPoint, CalculateSum{true}));
-        dataPoint.clear();
-    }
+    const auto& dataPointHistory = simulation_->getDataPointHistory();
+    const auto level = dataPointHistory.getCoarsestLevelFor(getPlotTimeIntervalNanoseconds());
+    const auto levelInterval = ch::duration<double>(dataPointHistory.getLevelInterval(level)).count();
 
-    // Simulation hasn't run yet, display plot for initial data
-    if (histograms.empty() && !dataPoints.empty())
-        histograms.push_back(getVelocityHistogramFromDataPoint(dataPoints.front(), CalculateSum{true}));
+    dataPointHistory.readLevel(
+        level,
+        [&](const std::deque<DataPoint>& dataPoints)
+        {
+            histograms.reserve(static_cast<std::size_t>(static_cast<double>(dataPoints.size()) * levelInterval /
+                                                        plotTimeInterval_.count()) +
+                               1);
+
+            // Only the velocity histogram is accumulated, the rest of the data points is skipped
+            cell::DenseHistogram velocityHistogram;
+            ch::nanoseconds elapsedTime{0};
+            int count = 0;
+
+            for (const auto& p : dataPoints)
+            {
+                if (count == 0)
+                    velocityHistogram = getVelocityHistogram(p);
+                else
+                    velocityHistogram += getVelocityHistogram(p);
+
+                elapsedTime += p.getData().elapsedTime;
+                ++count;
+
+                if (elapsedTime < plotTimeInterval_)
+                    continue;
+
+                velocityHistogram /= count;
+                histograms.push_back(reduceVelocityHistogram(velocityHistogram.toHistogram(), CalculateSum{true}));
+                elapsedTime = ch::nanoseconds{0};
+                count = 0;
+            }
+
+            // Simulation hasn't run yet, display plot for initial data
+            if (histograms.empty() && !dataPoints.empty())
+                histograms.push_back(getVelocityHistogramFromDataPoint(dataPoints.front(), CalculateSum{true}));
+        });
 
     emit setPlot(PlotWidget::ColorMapParams{.histograms = histograms, .xStep = plotTimeInterval_.count()});
 }
@@ -396,16 +436,23 @@ Histogram PlotModel::discardInactiveDiscTypes(const Histogram& histogram)
 
 Histogram PlotModel::getVelocityHistogramFromDataPoint(const DataPoint& dataPoint, CalculateSum calculateSum)
 {
-    cell::Histogram velocityHistogram;
+    return reduceVelocityHistogram(getVelocityHistogram(dataPoint).toHistogram(), calculateSum);
+}
+
+const cell::DenseHistogram& PlotModel::getVelocityHistogram(const DataPoint& dataPoint) const
+{
     switch (plotCategory_)
     {
-    case PlotCategory::XVelocityDistribution: velocityHistogram = dataPoint.getData().vxHistogram; break;
-    case PlotCategory::YVelocityDistribution: velocityHistogram = dataPoint.getData().vyHistogram; break;
+    case PlotCategory::XVelocityDistribution: return dataPoint.getData().vxHistogram;
+    case PlotCategory::YVelocityDistribution: return dataPoint.getData().vyHistogram;
     case PlotCategory::AbsoluteVelocityDistribution:
-    case PlotCategory::VelocityColorMap: velocityHistogram = dataPoint.getData().vHistogram; break;
+    case PlotCategory::VelocityColorMap: return dataPoint.getData().vHistogram;
     default: throw ExceptionWithLocation("Invalid plot category");
     }
+}
 
+Histogram PlotModel::reduceVelocityHistogram(const Histogram& velocityHistogram, CalculateSum calculateSum)
+{
     auto h = discardInactiveDiscTypes(velocityHistogram);
     if (calculateSum.value)
         h = sumHistogramStacks(h);
@@ -413,6 +460,24 @@ Histogram PlotModel::getVelocityHistogramFromDataPoint(const DataPoint& dataPoin
     return h;
 }
 
+void PlotModel::averageActiveMap(std::unordered_map<DiscTypeID, double>& activeMap, const ch::nanoseconds& elapsedTime,
+                                 int count) const
+{
+    // Same as DataPoint::average with normalized collision counts
+    if (plotCategory_ == PlotCategory::CollisionCounts)
+    {
+        if (elapsedTime.count() > 0)
+            cell::divideMapByValue(activeMap, elapsedTime.count());
+    }
+    else if (count > 0)
+        cell::divideMapByValue(activeMap, count);
+}
+
+ch::nanoseconds PlotModel::getPlotTimeIntervalNanoseconds() const
+{
+    return ch::round<ch::nanoseconds>(plotTimeInterval_);
+}
+
 Histogram PlotModel::makeHistogramWithCategories(const Histogram& source, const std::vector<DiscTypeID>& categories)
 {
     const auto& regularAxis = source.axis<1>();
@@ -63,6 +63,11 @@ private:
     Histogram sumHistogramStacks(const Histogram& histogram);
     Histogram discardInactiveDiscTypes(const Histogram& histogram);
     Histogram getVelocityHistogramFromDataPoint(const DataPoint& dataPoint, CalculateSum calculateSum);
+    const cell::DenseHistogram& getVelocityHistogram(const DataPoint& dataPoint) const;
+    Histogram reduceVelocityHistogram(const Histogram& velocityHistogram, CalculateSum calculateSum);
+    void averageActiveMap(std::unordered_map<DiscTypeID, double>& activeMap, const ch::nanoseconds& elapsedTime,
+                          int count) const;
+    ch::nanoseconds getPlotTimeIntervalNanoseconds() const;
     Histogram makeHistogramWithCategories(const Histogram& source, const std::vector<DiscTypeID>& categories);
 
     DataPoint createDataPoint() const;
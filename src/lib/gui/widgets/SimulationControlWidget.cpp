@@ -14,6 +14,13 @@ SimulationControlWidget::SimulationControlWidget(QWidget* parent)
     connect(ui->reactionsPushButton, &QPushButton::clicked, [&]() { emit editReactionsClicked(); });
     connect(ui->setupPushButton, &QPushButton::clicked, [&]() { emit editSetupClicked(); });
     connect(ui->startStopButton, &QPushButton::clicked, this, &SimulationControlWidget::toggleStartStopButtonState);
+    connect(ui->pauseButton, &QPushButton::toggled,
+            [&](bool paused)
+            {
+                ui->stepButton->setEnabled(paused);
+                emit simulationPauseToggled(paused);
+            });
+    connect(ui->stepButton, &QPushButton::clicked, [&]() { emit simulationStepClicked(); });
     connect(ui->fitIntoViewButton, &QPushButton::clicked, [&]() { emit fitIntoViewRequested(); });
     connect(ui->reinitializeButton, &QPushButton::clicked, this, &SimulationControlWidget::reset);
 }
@@ -23,6 +30,11 @@ SimulationControlWidget::~SimulationControlWidget() = default;
 void SimulationControlWidget::updateWidgets(SimulationRunning simulationRunning)
 {
     setWidgetsEnabled(!simulationRunning.value);
+
+    // Starting the simulation again always resumes it
+    ui->pauseButton->setChecked(false);
+    ui->pauseButton->setEnabled(simulationRunning.value);
+
     if (simulationRunning.value)
         ui->startStopButton->setText("Stop");
     else
@@ -31,7 +43,10 @@ void SimulationControlWidget::updateWidgets(SimulationRunning simulationRunning)
 
 void SimulationControlWidget::setWidgetsEnabled(bool value)
 {
-    ui->settingsWidget->setEnabled(value);
+    // Reactions are swapped in the running simulation, all other settings need a reset
+    for (auto* button : {ui->discTypesPushButton, ui->discsPushButton, ui->membraneTypesPushButton,
+                         ui->membranesPushButton, ui->setupPushButton})
+        button->setEnabled(value);
     ui->reinitializeButton->setEnabled(value);
 }
 
@@ -30,6 +30,8 @@ private:
 signals:
     void simulationStartClicked();
     void simulationStopClicked();
+    void simulationPauseToggled(bool paused);
+    void simulationStepClicked();
     void simulationResetTriggered();
     void editDiscTypesClicked();
     void editDiscsClicked();
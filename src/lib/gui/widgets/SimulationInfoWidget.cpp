@@ -32,4 +32,11 @@ void SimulationInfoWidget::setPerformanceData(const cell::SimulationRunner::Perf
     const std::string simulationUpdateTimeString = cell::stringutils::timeString(
         ch::duration_cast<ch::nanoseconds>(performanceData.timePerSimulationUpdate).count(), 3);
     ui->simulationTimeLabel->setText(QString("t_S: %1").arg(QString::fromStdString(simulationUpdateTimeString)));
+
+    const std::string timeStepString = cell::stringutils::timeString(performanceData.timeStep.count(), 3);
+    ui->timeStepLabel->setText(QString("dt: %1").arg(QString::fromStdString(timeStepString)));
+
+    const std::string pacingErrorString = cell::stringutils::timeString(performanceData.pacingError.count(), 3);
+    ui->pacingErrorLabel->setText(QString("Perr: %1").arg(QString::fromStdString(pacingErrorString)));
+    ui->fidelityLevelLabel->setText(QString("QoS level: %1").arg(performanceData.fidelityLevel));
 }
\ No newline at end of file
@@ -11,20 +11,85 @@
 #include <QMessageBox>
 #include <SFML/Graphics/CircleShape.hpp>
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 
 namespace chrono = std::chrono;
 
+namespace
+{
+
+constexpr unsigned int DiscTextureSize = 256;
+
+/**
+ * @brief White circle with an anti-aliased edge on a transparent background
+ */
+sf::Image createCircleImage()
+{
+    sf::Image image({DiscTextureSize, DiscTextureSize}, sf::Color::Transparent);
+    const float center = static_cast<float>(DiscTextureSize) / 2.0f;
+
+    for (unsigned int y = 0; y < DiscTextureSize; ++y)
+    {
+        for (unsigned int x = 0; x < DiscTextureSize; ++x)
+        {
+            const float dx = static_cast<float>(x) + 0.5f - center;
+            const float dy = static_cast<float>(y) + 0.5f - center;
+            const float coverage = std::clamp(center - std::sqrt(dx * dx + dy * dy) + 0.5f, 0.0f, 1.0f);
+
+            image.setPixel({x, y}, sf::Color(255, 255, 255, static_cast<std::uint8_t>(coverage * 255.0f)));
+        }
+    }
+
+    return image;
+}
+
+void appendDisc(sf::VertexArray& vertices, const sf::Vector2f& center, float radius, const sf::Color& color)
+{
+    static constexpr float T = static_cast<float>(DiscTextureSize);
+    static constexpr std::array<sf::Vector2f, 4> texCoords{sf::Vector2f{0, 0}, {T, 0}, {0, T}, {T, T}};
+
+    // 2 triangles per quad
+    static constexpr std::array<std::size_t, 6> indices{0, 1, 2, 2, 1, 3};
+    const std::array<sf::Vector2f, 4> corners{sf::Vector2f{center.x - radius, center.y - radius},
+                                              {center.x + radius, center.y - radius},
+                                              {center.x - radius, center.y + radius},
+                                              {center.x + radius, center.y + radius}};
+
+    for (const auto index : indices)
+        vertices.append(sf::Vertex{corners[index], color, texCoords[index]});
+}
+
+bool circleIntersectsRect(const sf::Vector2f& center, float radius, const sf::FloatRect& rect)
+{
+    return center.x + radius >= rect.position.x && center.x - radius <= rect.position.x + rect.size.x &&
+           center.y + radius >= rect.position.y && center.y - radius <= rect.position.y + rect.size.y;
+}
+
+} // namespace
+
 SimulationWidget::SimulationWidget(QWidget* parent)
     : QSFMLWidget(parent)
 {
     setContextMenuPolicy(Qt::DefaultContextMenu);
     connect(&renderingTimer_, &QTimer::timeout, this, &SimulationWidget::drawFrame);
     renderingTimer_.setTimerType(Qt::PreciseTimer);
+
+    if (!discTexture_.loadFromImage(createCircleImage()))
+        throw ExceptionWithLocation("Couldn't create the disc texture");
+
+    discTexture_.setSmooth(true);
 }
 
 void SimulationWidget::injectDependencies(SimulationConfigUpdater* simulationConfigUpdater, Simulation* simulation)
 {
     simulationConfigUpdater_ = simulationConfigUpdater;
+    simulation_ = simulation;
     renderingTimer_.setInterval(qRound(1000.0 / simulationConfigUpdater->getFPS()));
 
     connect(simulationConfigUpdater, &SimulationConfigUpdater::fpsChanged,
@@ -88,9 +153,6 @@ void SimulationWidget::toggleFullscreen()
 
 void SimulationWidget::contextMenuEvent(QContextMenuEvent* event)
 {
-    if (renderingTimer_.isActive())
-        return;
-
     QMenu menu(this);
     const QPoint cursorPosition = event->pos();
 
@@ -113,7 +175,10 @@ void SimulationWidget::contextMenuEvent(QContextMenuEvent* event)
     };
 
     const auto& config = simulationConfigUpdater_->getSimulationConfig();
-    fillMenu(menu.addMenu("Add membrane..."), config.membraneTypes, &SimulationWidget::addMembraneAtCursor);
+
+    // New membranes change the compartment structure and need a reset, discs can be added while the simulation runs
+    if (!renderingTimer_.isActive())
+        fillMenu(menu.addMenu("Add membrane..."), config.membraneTypes, &SimulationWidget::addMembraneAtCursor);
     fillMenu(menu.addMenu("Add disc..."), config.discTypes, &SimulationWidget::addDiscAtCursor);
 
     menu.exec(event->globalPos());
@@ -128,21 +193,21 @@ void SimulationWidget::fitSimulationIntoView()
 void SimulationWidget::rebuildTypeShapes(const cell::DiscTypeRegistry& discTypeRegistry,
                                          const cell::MembraneTypeRegistry& membraneTypeRegistry)
 {
-    discTypeShapes_.resize(discTypeRegistry.getValues().size());
+    discTypeBatches_.resize(discTypeRegistry.getValues().size());
     membraneTypeShapes_.resize(membraneTypeRegistry.getValues().size());
-    sf::CircleShape circleShape;
+
+    maxDiscRadius_ = 0;
 
     for (const auto& type : discTypeRegistry.getValues())
     {
-        const auto ID = discTypeRegistry.getIDFor(type.getName());
-
-        circleShape.setRadius(static_cast<float>(type.getRadius()));
-        circleShape.setFillColor(simulationConfigUpdater_->getDiscTypeColorMap().at(type.getName()));
-        circleShape.setOrigin(sf::Vector2f{static_cast<float>(type.getRadius()), static_cast<float>(type.getRadius())});
+        auto& batch = discTypeBatches_[discTypeRegistry.getIDFor(type.getName())];
 
-        discTypeShapes_[ID] = circleShape;
+        batch.radius = static_cast<float>(type.getRadius());
+        batch.color = simulationConfigUpdater_->getDiscTypeColorMap().at(type.getName());
+        maxDiscRadius_ = std::max(maxDiscRadius_, batch.radius);
     }
 
+    sf::CircleShape circleShape;
     circleShape.setPointCount(100);
     for (const auto& type : membraneTypeRegistry.getValues())
     {
@@ -163,15 +228,8 @@ void SimulationWidget::rebuildTypeShapes(const cell::DiscTypeRegistry& discTypeR
     }
 }
 
-void SimulationWidget::queueFrameForRendering(Frame frame)
+void SimulationWidget::renderFrameImmediately()
 {
-    frame_ = std::move(frame);
-}
-
-void SimulationWidget::renderFrameImmediately(Frame frame)
-{
-    queueFrameForRendering(std::move(frame));
-
     // Use the next draw event, otherwise we'll get a huge FPS increase that could crash the GUI if the user
     // drags the view and causes continuous redraws while the simulation is running
     if (renderingTimer_.isActive())
@@ -186,17 +244,76 @@ void SimulationWidget::drawFrame()
     const auto start = myClock::now();
     sf::RenderWindow::clear(sf::Color::Black);
 
-    for (const auto& disc : frame_.discs)
+    // Picks up the most recent frame the simulation thread published, intermediate frames were never copied
+    const auto* latestFrame = simulation_->getLatestFrame();
+    if (!latestFrame)
+    {
+        sf::RenderWindow::display();
+        return;
+    }
+
+    const auto& frame = *latestFrame;
+    const auto visibleArea = getVisibleArea();
+    const auto zoom = static_cast<float>(QSFMLWidget::getCurrentZoom());
+    bool drawDensity = false;
+
+    for (auto& batch : discTypeBatches_)
     {
-        discTypeShapes_[disc.getTypeID()].setPosition(utility::toVector2f(disc.getPosition()));
-        sf::RenderWindow::draw(discTypeShapes_[disc.getTypeID()]);
+        batch.vertices.clear();
+
+        // Discs smaller than a pixel wouldn't be recognizable as circles anyway
+        batch.drawAsDensity = batch.radius / zoom < 0.5f;
+        drawDensity |= batch.drawAsDensity;
     }
 
-    for (const auto& membrane : frame_.membranes)
+    if (drawDensity)
+        densityImage_.resize(sf::RenderWindow::getSize(), sf::Color::Transparent);
+
+    for (std::size_t i = 0; i < frame.membranes.size(); ++i)
     {
+        const auto& membrane = frame.membranes[i];
         auto& membraneTypeShape = membraneTypeShapes_[membrane.getTypeID()];
-        membraneTypeShape.setOutlineThickness(static_cast<float>(QSFMLWidget::getCurrentZoom()));
-        membraneTypeShape.setPosition(utility::toVector2f(membrane.getPosition()));
+        const auto membranePosition = utility::toVector2f(membrane.getPosition());
+
+        // All discs of a compartment are inside of its membrane (intruders might stick out by their radius), so if the
+        // membrane isn't visible, the whole compartment can be skipped
+        if (!circleIntersectsRect(membranePosition, membraneTypeShape.getRadius() + maxDiscRadius_, visibleArea))
+            continue;
+
+        for (std::size_t j = frame.discOffsets[i]; j < frame.discOffsets[i + 1]; ++j)
+        {
+            const auto& disc = frame.discs[j];
+            auto& batch = discTypeBatches_[disc.getTypeID()];
+            const auto position = utility::toVector2f(disc.getPosition());
+
+            if (!circleIntersectsRect(position, batch.radius, visibleArea))
+                continue;
+
+            if (batch.drawAsDensity)
+                addToDensityImage(position, batch.color, visibleArea);
+            else
+                appendDisc(batch.vertices, position, batch.radius, batch.color);
+        }
+    }
+
+    sf::RenderStates renderStates;
+    renderStates.texture = &discTexture_;
+    for (const auto& batch : discTypeBatches_)
+        sf::RenderWindow::draw(batch.vertices, renderStates);
+
+    if (drawDensity)
+        drawDensityImage();
+
+    for (const auto& membrane : frame.membranes)
+    {
+        auto& membraneTypeShape = membraneTypeShapes_[membrane.getTypeID()];
+        const auto membranePosition = utility::toVector2f(membrane.getPosition());
+
+        if (!circleIntersectsRect(membranePosition, membraneTypeShape.getRadius(), visibleArea))
+            continue;
+
+        membraneTypeShape.setOutlineThickness(zoom);
+        membraneTypeShape.setPosition(membranePosition);
         sf::RenderWindow::draw(membraneTypeShape);
     }
 
@@ -219,6 +336,54 @@ void SimulationWidget::drawFrame()
     }
 }
 
+sf::FloatRect SimulationWidget::getVisibleArea() const
+{
+    const auto& view = sf::RenderWindow::getView();
+
+    return sf::FloatRect(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+}
+
+void SimulationWidget::addToDensityImage(const sf::Vector2f& position, const sf::Color& color,
+                                         const sf::FloatRect& visibleArea)
+{
+    const auto imageSize = densityImage_.getSize();
+    const float x = (position.x - visibleArea.position.x) / visibleArea.size.x * static_cast<float>(imageSize.x);
+    const float y = (position.y - visibleArea.position.y) / visibleArea.size.y * static_cast<float>(imageSize.y);
+
+    if (x < 0 || y < 0 || x >= static_cast<float>(imageSize.x) || y >= static_cast<float>(imageSize.y))
+        return;
+
+    const sf::Vector2u pixelPosition{static_cast<unsigned int>(x), static_cast<unsigned int>(y)};
+    auto pixel = densityImage_.getPixel(pixelPosition);
+
+    // Each disc makes its pixel more opaque, so densely populated regions stand out. Colors of different disc types
+    // in the same pixel are mixed
+    if (pixel.a == 0)
+        pixel = sf::Color(color.r, color.g, color.b, 0);
+    else
+        pixel = sf::Color(static_cast<std::uint8_t>((pixel.r + color.r) / 2),
+                          static_cast<std::uint8_t>((pixel.g + color.g) / 2),
+                          static_cast<std::uint8_t>((pixel.b + color.b) / 2), pixel.a);
+
+    pixel.a = static_cast<std::uint8_t>(std::min(255, pixel.a + 64));
+    densityImage_.setPixel(pixelPosition, pixel);
+}
+
+void SimulationWidget::drawDensityImage()
+{
+    if (densityTexture_.getSize() != densityImage_.getSize() && !densityTexture_.resize(densityImage_.getSize()))
+        throw ExceptionWithLocation("Couldn't create the density texture");
+
+    densityTexture_.update(densityImage_);
+
+    // The image covers the window pixel by pixel, so it's drawn without the zoomed and translated view
+    const sf::View view = sf::RenderWindow::getView();
+    const sf::Vector2f windowSize = static_cast<sf::Vector2f>(sf::RenderWindow::getSize());
+    sf::RenderWindow::setView(sf::View(sf::FloatRect({0.f, 0.f}, windowSize)));
+    sf::RenderWindow::draw(sf::Sprite(densityTexture_));
+    sf::RenderWindow::setView(view);
+}
+
 double SimulationWidget::calculateIdealZoom() const
 {
     if (!simulationConfigUpdater_)
@@ -268,10 +433,24 @@ void SimulationWidget::addObjectAtCursor(const QPoint& cursorPosition, const std
 
 void SimulationWidget::addDiscAtCursor(const QPoint& cursorPosition, const std::string& typeName)
 {
-    addObjectAtCursor<cell::config::Disc>(
-        cursorPosition, typeName, [](const auto& config) { return config.discs; },
-        [](auto& disc, const std::string& typeName) { disc.discTypeName = typeName; },
-        [](auto& config, auto discs) { config.discs = std::move(discs); });
+    const sf::Vector2f worldCoordinates = mapPixelToCoords(sf::Vector2i{cursorPosition.x(), cursorPosition.y()});
+    const cell::config::Disc disc{.discTypeName = typeName,
+                                  .x = static_cast<double>(worldCoordinates.x),
+                                  .y = static_cast<double>(worldCoordinates.y)};
+
+    try
+    {
+        // The disc is inserted into the current state, the config only needs it for the next reset
+        simulation_->applyCommand(cell::command::InsertDisc{disc});
+
+        auto config = simulationConfigUpdater_->getSimulationConfig();
+        config.discs.push_back(disc);
+        simulationConfigUpdater_->setSimulationConfig(config, EmitSimulationReset{false});
+    }
+    catch (const std::exception& exception)
+    {
+        QMessageBox::critical(this, "Error", exception.what());
+    }
 }
 
 void SimulationWidget::addMembraneAtCursor(const QPoint& cursorPosition, const std::string& typeName)
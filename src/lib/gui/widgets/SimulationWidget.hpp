@@ -5,6 +5,9 @@
 #include "widgets/QSFMLWidget.hpp"
 
 #include <SFML/Graphics/CircleShape.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/System/Clock.hpp>
 
 #include <QTimer>
@@ -25,6 +28,23 @@ using myClock = std::chrono::steady_clock;
 class SimulationWidget : public QSFMLWidget
 {
     Q_OBJECT
+private:
+    /**
+     * @brief All discs of one type are drawn with a single draw call as textured quads, the texture being a white
+     * circle that is tinted with the color of the disc type
+     */
+    struct DiscTypeBatch
+    {
+        float radius = 0;
+        sf::Color color;
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+
+        /**
+         * @brief Set each frame if the discs are smaller than a pixel at the current zoom. They're then accumulated in
+         * a density image instead of being drawn as quads
+         */
+        bool drawAsDensity = false;
+    };
 
 public:
     SimulationWidget(QWidget* parent);
@@ -46,12 +66,14 @@ signals:
     void renderData(int targetFPS, int actualFPS, std::chrono::nanoseconds renderTime);
 
 public slots:
-    void queueFrameForRendering(Frame frame);
-    void renderFrameImmediately(Frame frame);
+    void renderFrameImmediately();
     void fitSimulationIntoView();
 
 private:
     void drawFrame();
+    sf::FloatRect getVisibleArea() const;
+    void addToDensityImage(const sf::Vector2f& position, const sf::Color& color, const sf::FloatRect& visibleArea);
+    void drawDensityImage();
     double calculateIdealZoom() const;
     sf::Vector2i getWidgetSize() const;
     template <typename ObjectType, typename ObjectsGetter, typename NameSetter, typename ObjectsSetter>
@@ -60,13 +82,17 @@ private:
     void addMembraneAtCursor(const QPoint& cursorPosition, const std::string& typeName);
 
 private:
-    std::vector<sf::CircleShape> discTypeShapes_;
+    std::vector<DiscTypeBatch> discTypeBatches_;
+    sf::Texture discTexture_;
+    float maxDiscRadius_ = 0;
+    sf::Image densityImage_;
+    sf::Texture densityTexture_;
     std::vector<sf::CircleShape> membraneTypeShapes_;
     SimulationConfigUpdater* simulationConfigUpdater_ = nullptr;
+    Simulation* simulation_ = nullptr;
     myClock::time_point currentRenderInterval_{};
     myClock::duration elapsedRenderTime_{};
     int renderedFrames_ = 0;
-    Frame frame_;
     QTimer renderingTimer_;
 };
 
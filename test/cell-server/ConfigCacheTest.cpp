@@ -0,0 +1,72 @@
+#include "ConfigCache.hpp"
+#include "cell/SimulationConfigBuilder.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+
+class AConfigCache : public Test
+{
+protected:
+    SimulationConfigBuilder builder;
+
+    void SetUp() override
+    {
+        builder.addDiscType("A", Radius{5}, Mass{1});
+        builder.setTimeStep(1ms);
+        builder.useDistribution(false);
+        builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 1, .y = 0});
+    }
+
+    SimulationConfig getConfigWithSpeed(double mostProbableSpeed)
+    {
+        builder.setMostProbableSpeed(mostProbableSpeed);
+        return builder.getSimulationConfig();
+    }
+};
+
+TEST_F(AConfigCache, BuildsEachConfigOnce)
+{
+    ConfigCache configCache(2);
+    bool wasCached = true;
+
+    const auto builtConfig = configCache.get(getConfigWithSpeed(1), wasCached);
+    EXPECT_THAT(wasCached, Eq(false));
+    EXPECT_THAT(builtConfig->createCheckpoint().discs.size(), Eq(1u));
+
+    EXPECT_THAT(configCache.get(getConfigWithSpeed(1), wasCached), Eq(builtConfig));
+    EXPECT_THAT(wasCached, Eq(true));
+}
+
+TEST_F(AConfigCache, EvictsTheLeastRecentlyUsedConfig)
+{
+    ConfigCache configCache(2);
+    bool wasCached = false;
+
+    configCache.get(getConfigWithSpeed(1), wasCached);
+    configCache.get(getConfigWithSpeed(2), wasCached);
+    configCache.get(getConfigWithSpeed(1), wasCached);
+    configCache.get(getConfigWithSpeed(3), wasCached);
+
+    configCache.get(getConfigWithSpeed(1), wasCached);
+    EXPECT_THAT(wasCached, Eq(true));
+    configCache.get(getConfigWithSpeed(2), wasCached);
+    EXPECT_THAT(wasCached, Eq(false));
+}
+
+TEST_F(AConfigCache, DoesntKeepConfigsThatFailedToBuild)
+{
+    ConfigCache configCache(2);
+    bool wasCached = true;
+    builder.addDisc("Unknown", Position{.x = 0, .y = 0}, Velocity{.x = 0, .y = 0});
+
+    EXPECT_ANY_THROW(configCache.get(builder.getSimulationConfig(), wasCached));
+    EXPECT_THAT(wasCached, Eq(false));
+
+    wasCached = true;
+    EXPECT_ANY_THROW(configCache.get(builder.getSimulationConfig(), wasCached));
+    EXPECT_THAT(wasCached, Eq(false));
+}
@@ -0,0 +1,76 @@
+#include "JobPool.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+
+TEST(AJobPool, RejectsJobsOnceTheQueueIsFull)
+{
+    JobPool jobPool(1, 1);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    ASSERT_THAT(jobPool.submit(
+                    [&]
+                    {
+                        started.set_value();
+                        released.wait();
+                    }),
+                Eq(true));
+    started.get_future().wait();
+
+    EXPECT_THAT(jobPool.submit([] {}), Eq(true));
+    EXPECT_THAT(jobPool.submit([] {}), Eq(false));
+
+    release.set_value();
+}
+
+TEST(AJobPool, AcceptsJobsForIdleThreadsWithoutAQueue)
+{
+    JobPool jobPool(2, 0);
+    std::promise<void> finished;
+
+    // Gives the threads time to start waiting for jobs
+    std::this_thread::sleep_for(50ms);
+
+    ASSERT_THAT(jobPool.submit([&] { finished.set_value(); }), Eq(true));
+    EXPECT_THAT(finished.get_future().wait_for(1s), Eq(std::future_status::ready));
+}
+
+TEST(AJobPool, FinishesRunningJobsAndDiscardsQueuedOnesWhenDestroyed)
+{
+    std::atomic<bool> runningJobFinished = false;
+    std::atomic<bool> queuedJobRan = false;
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    auto jobPool = std::make_unique<JobPool>(1, 1);
+    jobPool->submit(
+        [&]
+        {
+            started.set_value();
+            released.wait();
+            runningJobFinished = true;
+        });
+    started.get_future().wait();
+    jobPool->submit([&] { queuedJobRan = true; });
+
+    std::jthread releaser(
+        [&]
+        {
+            std::this_thread::sleep_for(50ms);
+            release.set_value();
+        });
+    jobPool.reset();
+
+    EXPECT_THAT(runningJobFinished, Eq(true));
+    EXPECT_THAT(queuedJobRan, Eq(false));
+}
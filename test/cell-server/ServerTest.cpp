@@ -0,0 +1,190 @@
+#include "Server.hpp"
+#include "cell/SimulationConfigBuilder.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <fstream>
+#include <sstream>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+using json = nlohmann::json;
+
+class AServer : public Test
+{
+protected:
+    const fs::path socketPath = "server.sock";
+    const fs::path outFile = "serverTypeCounts.csv";
+    Server::Params serverParams{.socketPath = socketPath, .threadCount = 1};
+    std::atomic<bool> stopRequested = false;
+    std::unique_ptr<Server> server;
+    std::jthread serverThread;
+    SimulationConfigBuilder builder;
+
+    void SetUp() override
+    {
+        server = std::make_unique<Server>(serverParams);
+        serverThread = std::jthread([this] { server->run(stopRequested); });
+
+        builder.addDiscType("A", Radius{5}, Mass{1});
+        builder.setTimeStep(1ms);
+        builder.useDistribution(false);
+        builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 1, .y = 0});
+    }
+
+    void TearDown() override
+    {
+        stopRequested = true;
+        serverThread.join();
+        server.reset();
+        fs::remove(outFile);
+    }
+
+    int connect()
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        const auto path = socketPath.string();
+        std::copy(path.begin(), path.end(), address.sun_path);
+
+        const auto clientSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(clientSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+            ADD_FAILURE() << "Couldn't connect to the server";
+
+        return clientSocket;
+    }
+
+    /**
+     * @brief Sends the lines, shuts down the sending side and returns all messages until the server closed the socket
+     */
+    std::vector<json> exchange(const std::vector<std::string>& lines)
+    {
+        const auto clientSocket = connect();
+        for (const auto& line : lines)
+            ::send(clientSocket, (line + "\n").data(), line.size() + 1, 0);
+        ::shutdown(clientSocket, SHUT_WR);
+
+        std::string received;
+        std::array<char, 4096> chunk;
+        for (ssize_t size; (size = ::recv(clientSocket, chunk.data(), chunk.size(), 0)) > 0;)
+            received.append(chunk.data(), static_cast<std::size_t>(size));
+        ::close(clientSocket);
+
+        std::vector<json> messages;
+        std::istringstream stream(received);
+        for (std::string line; std::getline(stream, line);)
+        {
+            const auto message = json::parse(line);
+            if (message["event"] != "performance")
+                messages.push_back(message);
+        }
+
+        return messages;
+    }
+
+    std::string createJob(double duration, const fs::path& jobOutFile)
+    {
+        return json{{"config", builder.getSimulationConfig()},
+                    {"duration", duration},
+                    {"storageInterval", 0.001},
+                    {"out", jobOutFile.string()},
+                    {"seed", 1}}
+            .dump();
+    }
+
+    std::string createJob(double duration)
+    {
+        return createJob(duration, outFile);
+    }
+
+    std::string readFile(const fs::path& path)
+    {
+        std::ifstream file(path);
+        std::stringstream content;
+        content << file.rdbuf();
+
+        return content.str();
+    }
+};
+
+class AServerWithTwoThreads : public AServer
+{
+protected:
+    const fs::path otherOutFile = "serverTypeCounts2.csv";
+
+    AServerWithTwoThreads()
+    {
+        serverParams.threadCount = 2;
+    }
+
+    void TearDown() override
+    {
+        AServer::TearDown();
+        fs::remove(otherOutFile);
+    }
+};
+
+TEST_F(AServer, AnswersJobsOfAClientThatStoppedSending)
+{
+    const auto messages = exchange({createJob(0.01)});
+
+    ASSERT_THAT(messages.size(), Eq(3u));
+    EXPECT_THAT(messages[0]["event"], Eq("queued"));
+    EXPECT_THAT(messages[1]["event"], Eq("started"));
+    EXPECT_THAT(messages[2]["event"], Eq("finished"));
+    EXPECT_THAT(messages[2]["job"], Eq(messages[0]["job"]));
+    EXPECT_THAT(fs::exists(outFile), Eq(true));
+}
+
+TEST_F(AServer, ReportsLinesThatArentJobs)
+{
+    const auto messages = exchange({"not json", json{{"duration", 1}}.dump()});
+
+    ASSERT_THAT(messages.size(), Eq(2u));
+    for (const auto& message : messages)
+    {
+        EXPECT_THAT(message["event"], Eq("error"));
+        EXPECT_THAT(message["job"].is_null(), Eq(true));
+    }
+}
+
+TEST_F(AServer, RejectsJobsWithInvalidDurations)
+{
+    const auto messages = exchange({createJob(0)});
+
+    ASSERT_THAT(messages.size(), Eq(1u));
+    EXPECT_THAT(messages[0]["event"], Eq("error"));
+}
+
+TEST_F(AServerWithTwoThreads, RunsConcurrentJobsIndependently)
+{
+    builder.addDiscType("B", Radius{5}, Mass{1});
+    builder.setDistribution("", {{"A", 1}});
+    builder.setDiscCount("", 2000);
+    builder.useDistribution(true);
+    builder.addReaction("A", "", "B", "", Probability{0.01});
+    builder.addReaction("A", "B", "B", "B", Probability{0.1});
+
+    // Builds and caches the config, so both concurrent jobs start from the same discs as this one
+    ASSERT_THAT(exchange({createJob(0.1)}).back()["event"], Eq("finished"));
+    const auto expectedTypeCounts = readFile(outFile);
+
+    std::vector<json> messages;
+    std::vector<json> otherMessages;
+    {
+        std::jthread client([&] { messages = exchange({createJob(0.1)}); });
+        otherMessages = exchange({createJob(0.1, otherOutFile)});
+    }
+
+    ASSERT_THAT(messages.back()["event"], Eq("finished"));
+    ASSERT_THAT(otherMessages.back()["event"], Eq("finished"));
+    EXPECT_THAT(readFile(outFile), Eq(expectedTypeCounts));
+    EXPECT_THAT(readFile(otherOutFile), Eq(expectedTypeCounts));
+}
@@ -3,12 +3,16 @@
 #include "cell/Disc.hpp"
 #include "cell/Membrane.hpp"
 #include "cell/MembraneType.hpp"
+#include "cell/Reaction.hpp"
+#include "cell/ReactionEngine.hpp"
 #include "cell/SimulationConfigBuilder.hpp"
 #include "cell/SimulationFactory.hpp"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 using namespace testing;
 using namespace cell;
 
@@ -94,7 +98,7 @@ TEST_F(ACell, SimulatesASingleDisc)
     ASSERT_THAT(cell.getDiscs().front().getPosition().x, DoubleNear(50 + timeStep, MaxPositionError));
     ASSERT_THAT(cell.getDiscs().front().getPosition().y, DoubleNear(50 + timeStep, MaxPositionError));
 
-    ASSERT_THAT(CollisionDetector::getAndResetCollisionCounts().empty(), Eq(true));
+    ASSERT_THAT(cell.getAndResetCollisionCounts().empty(), Eq(true));
 }
 
 TEST_F(ACell, SimulatesUnimolecularReactions)
@@ -113,7 +117,7 @@ TEST_F(ACell, SimulatesUnimolecularReactions)
     ASSERT_THAT(discTypeCounts["B"], Eq(2));
     ASSERT_THAT(discTypeCounts["C"], Eq(0));
 
-    auto collisionCounts = CollisionDetector::getAndResetCollisionCounts();
+    auto collisionCounts = cell.getAndResetCollisionCounts();
     auto getIDFor = [&](const std::string& name) { return getDiscTypeRegistry().getIDFor(name); };
 
     ASSERT_THAT(collisionCounts[getIDFor("A")], Eq(0));
@@ -140,7 +144,7 @@ TEST_F(ACell, SimulatesBimolecularReactions)
     EXPECT_THAT(discTypeCounts["B"], Eq(1));
     EXPECT_THAT(discTypeCounts["C"], Eq(2));
 
-    auto collisionCounts = CollisionDetector::getAndResetCollisionCounts();
+    auto collisionCounts = cell.getAndResetCollisionCounts();
 
     EXPECT_THAT(collisionCounts[getIDFor("A")], Eq(2));
     EXPECT_THAT(collisionCounts[getIDFor("B")], Eq(1));
@@ -193,7 +197,7 @@ TEST_F(ACell, SimulatesReactionsOfDiscsInDifferentCompartments)
     ASSERT_EQ(discs.size(), 1);
     EXPECT_EQ(getDiscTypeRegistry().getByID(discs.front().getTypeID()).getName(), "C");
 
-    const auto& collisionCounts = CollisionDetector::getAndResetCollisionCounts();
+    const auto& collisionCounts = cell.getAndResetCollisionCounts();
 
     ASSERT_EQ(collisionCounts.size(), 2);
     EXPECT_TRUE(collisionCounts.contains(getIDFor("A")) && collisionCounts.at(getIDFor("A")) == 1);
@@ -210,7 +214,7 @@ TEST_F(ACell, SimulatesNewDiscsCorrectly)
 
     auto& cell = createAndUpdateCell();
     auto discs = getAllDiscs(cell);
-    CollisionDetector::getAndResetCollisionCounts(); // Discard the collision between A and B
+    cell.getAndResetCollisionCounts(); // Discard the collision between A and B
 
     ASSERT_EQ(discs.size(), 2);
     auto discC = getDisc(discs, "C");
@@ -219,7 +223,7 @@ TEST_F(ACell, SimulatesNewDiscsCorrectly)
     cell.update(timeStep);
     discs = getAllDiscs(cell);
 
-    auto collisions = CollisionDetector::getAndResetCollisionCounts();
+    auto collisions = cell.getAndResetCollisionCounts();
     ASSERT_EQ(collisions.size(), 2);
     ASSERT_TRUE(collisions.contains(getDiscTypeRegistry().getIDFor("C")));
     ASSERT_TRUE(collisions.contains(getDiscTypeRegistry().getIDFor("D")));
@@ -262,4 +266,241 @@ TEST_F(ACell, EnforcesAreaConservationOfReactions)
 
     builder.setReactionsConserveArea(true);
     EXPECT_THROW(createAndUpdateCell(), InvalidReactionsException);
+}
+
+TEST_F(ACell, MeasuresTheMaximumSpeedPerRadiusOfAllCompartments)
+{
+    builder.addMembraneType("M", Radius{100}, {});
+    builder.addMembrane("M", Position{.x = 500, .y = 500});
+
+    builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 3, .y = 4});
+    builder.addDisc("B", Position{.x = 500, .y = 500}, Velocity{.x = 20, .y = 0});
+
+    auto& cell = createAndUpdateCell();
+
+    EXPECT_NEAR(cell.getMaxSpeedPerRadius(), 4.0, 1e-12);
+    EXPECT_NEAR(cell.getCompartments().front()->getMaxSpeedPerRadius(), 4.0, 1e-12);
+}
+
+TEST_F(ACell, RejectsAdaptiveTimeStepsWithAnEmptyRange)
+{
+    auto simulationConfig = builder.getSimulationConfig();
+    simulationConfig.useAdaptiveTimeStep = true;
+    simulationConfig.minTimeStep = simulationConfig.maxTimeStep + 1;
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(simulationConfig), InvalidSetupException);
+
+    simulationConfig.minTimeStep = simulationConfig.maxTimeStep;
+    EXPECT_NO_THROW(SimulationFactory::validateSimulationConfig(simulationConfig));
+}
+
+TEST_F(ACell, RejectsInvalidStepSettings)
+{
+    auto simulationConfig = builder.getSimulationConfig();
+    simulationConfig.collisionSubsteps = 0;
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(simulationConfig), InvalidSetupException);
+
+    simulationConfig.collisionSubsteps = 1;
+    simulationConfig.neighborListSkin = -1;
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(simulationConfig), InvalidSetupException);
+
+    simulationConfig.neighborListSkin = 0;
+    simulationConfig.useAdaptiveTimeStep = true;
+    simulationConfig.maxDisplacementFraction = 0;
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(simulationConfig), InvalidSetupException);
+
+    simulationConfig.maxDisplacementFraction = 0.25;
+    EXPECT_NO_THROW(SimulationFactory::validateSimulationConfig(simulationConfig));
+}
+
+TEST_F(ACell, DetectsCollisionsInSubsteps)
+{
+    // Within a single step of 1s, these discs would pass through each other without ever overlapping
+    builder.addDisc("A", Position{.x = -20, .y = 0}, Velocity{.x = 40, .y = 0});
+    builder.addDisc("B", Position{.x = 20, .y = 0}, Velocity{.x = -40, .y = 0});
+    builder.setCollisionSubsteps(8);
+
+    auto& cell = createAndUpdateCell();
+
+    const auto& discs = cell.getDiscs();
+    EXPECT_THAT(getDisc(discs, "A").getVelocity().x, DoubleNear(-40, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "B").getVelocity().x, DoubleNear(40, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "A").getPosition().x, Lt(0));
+    EXPECT_THAT(getDisc(discs, "B").getPosition().x, Gt(0));
+}
+
+TEST_F(ACell, ResolvesCollisionsAtTheirExactTimeWhenEventDriven)
+{
+    builder.setCollisionEngine(config::CollisionEngine::EventDriven);
+    builder.addDisc("A", Position{.x = -20, .y = 0}, Velocity{.x = 10, .y = 0});
+    builder.addDisc("B", Position{.x = 20, .y = 0}, Velocity{.x = -10, .y = 0});
+    builder.addDisc("D", Position{.x = 980, .y = 0}, Velocity{.x = 10, .y = 0});
+
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+    auto& cell = simulationFactory.getCell();
+
+    // A and B touch after 1.5s, D touches the cell membrane after 1.5s
+    cell.getAndResetCollisionCounts();
+    cell.update(3);
+
+    const auto& discs = cell.getDiscs();
+    EXPECT_THAT(getDisc(discs, "A").getPosition().x, DoubleNear(-20, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "A").getVelocity().x, DoubleNear(-10, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "B").getPosition().x, DoubleNear(20, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "D").getPosition().x, DoubleNear(980, MaxPositionError));
+    EXPECT_THAT(getDisc(discs, "D").getVelocity().x, DoubleNear(-10, MaxPositionError));
+
+    auto collisionCounts = cell.getAndResetCollisionCounts();
+    EXPECT_THAT(collisionCounts[getIDFor("A")], Eq(1));
+    EXPECT_THAT(collisionCounts[getIDFor("B")], Eq(1));
+}
+
+TEST_F(ACell, MovesDiscsThroughPermeableMembranesWhenEventDriven)
+{
+    builder.setCollisionEngine(config::CollisionEngine::EventDriven);
+    builder.addMembraneType("M", Radius{100},
+                            {{"A", MembraneType::Permeability::Bidirectional}, {"B", MembraneType::Permeability::None}});
+    builder.addMembrane("M", Position{.x = 0, .y = 0});
+
+    builder.addDisc("A", Position{.x = 0, .y = 200}, Velocity{.x = 0, .y = -50});
+    builder.addDisc("B", Position{.x = 0, .y = -200}, Velocity{.x = 0, .y = 50});
+
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+    auto& cell = simulationFactory.getCell();
+    cell.update(3);
+
+    const auto& compartment = *cell.getCompartments().front();
+    ASSERT_THAT(compartment.getDiscs().size(), Eq(1u));
+    EXPECT_THAT(compartment.getDiscs().front().getTypeID(), Eq(getIDFor("A")));
+
+    ASSERT_THAT(cell.getDiscs().size(), Eq(1u));
+    EXPECT_THAT(cell.getDiscs().front().getPosition().y, DoubleNear(-160, MaxPositionError));
+}
+
+TEST_F(ACell, IsEditedInPlaceByCommands)
+{
+    builder.addMembraneType("M", Radius{100}, {});
+    builder.addMembrane("M", Position{.x = 0, .y = 0});
+    builder.addDisc("B", Position{.x = 0, .y = -200}, Velocity{.x = 0, .y = 0});
+
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+    auto& cell = simulationFactory.getCell();
+    const auto& compartment = *cell.getCompartments().front();
+
+    simulationFactory.applyCommand(command::InsertDisc{config::Disc{.discTypeName = "A", .x = 10, .y = 0}});
+    ASSERT_THAT(compartment.getDiscs().size(), Eq(1u));
+    EXPECT_THROW(simulationFactory.validateCommand(command::InsertDisc{config::Disc{.discTypeName = "A", .y = 98}}),
+                 ExceptionWithLocation);
+
+    simulationFactory.applyCommand(command::AddReaction{config::Reaction{.educt1 = "A", .product1 = "B"}});
+    EXPECT_THROW(simulationFactory.applyCommand(command::AddReaction{config::Reaction{.educt1 = "A", .product1 = "A"}}),
+                 ExceptionWithLocation);
+    simulationFactory.applyCommand(
+        command::SetReactionProbability{config::Reaction{.educt1 = "A", .product1 = "B", .probability = 1}});
+    cell.update(timeStep);
+    ASSERT_THAT(compartment.getDiscs().size(), Eq(1u));
+    EXPECT_THAT(compartment.getDiscs().front().getTypeID(), Eq(getIDFor("B")));
+
+    simulationFactory.applyCommand(command::SetPermeability{"M", "B", MembraneType::Permeability::Inward});
+    const auto& membraneTypeRegistry = simulationFactory.getSimulationContext().membraneTypeRegistry;
+    EXPECT_THAT(membraneTypeRegistry.getByID(membraneTypeRegistry.getIDFor("M")).getPermeabilityFor(getIDFor("B")),
+                Eq(MembraneType::Permeability::Inward));
+
+    simulationFactory.applyCommand(command::RemoveDiscs{.center = {0, -200}, .radius = 10});
+    EXPECT_THAT(cell.getDiscs().empty(), Eq(true));
+    EXPECT_THAT(compartment.getDiscs().size(), Eq(1u));
+}
+
+TEST_F(ACell, SwapsItsReactionsAtTheStartOfAnUpdate)
+{
+    builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 0, .y = 0});
+    builder.addReaction("A", "", "D", "", Probability{0});
+
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+    auto& cell = simulationFactory.getCell();
+    const auto& reactionEngine = simulationFactory.getSimulationContext().reactionEngine;
+    const auto initialReactions = reactionEngine.getActiveReactions();
+
+    simulationFactory.applyCommand(command::SetReactions{{config::Reaction{.educt1 = "A", .product1 = "B"}}});
+    simulationFactory.applyCommand(
+        command::SetReactionProbability{config::Reaction{.educt1 = "A", .product1 = "B", .probability = 1}});
+    ASSERT_THAT(reactionEngine.getActiveReactions(), Eq(initialReactions));
+
+    cell.update(timeStep);
+
+    ASSERT_THAT(cell.getDiscs().size(), Eq(1u));
+    EXPECT_THAT(cell.getDiscs().front().getTypeID(), Eq(getIDFor("B")));
+    EXPECT_THAT(reactionEngine.getActiveReactions()->version, Gt(initialReactions->version + 1));
+    EXPECT_THAT(initialReactions->unimolecularReactions.at(getIDFor("A")).front().getProduct1(), Eq(getIDFor("D")));
+}
+
+TEST_F(ACell, IsClonedIntoReplicasThatShareItsTypes)
+{
+    builder.addMembraneType("M", Radius{100}, {});
+    builder.addMembrane("M", Position{.x = 0, .y = 0});
+    builder.addDisc("A", Position{.x = 10, .y = 0}, Velocity{.x = 1, .y = 0});
+    builder.addDisc("B", Position{.x = 0, .y = -200}, Velocity{.x = 0, .y = 1});
+    builder.addReaction("B", "", "D", "", Probability{0});
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+
+    auto replicaConfig = builder.getSimulationConfig();
+    replicaConfig.reactions.front().probability = 1;
+    SimulationFactory replicaFactory;
+    replicaFactory.buildReplicaOf(simulationFactory, replicaConfig);
+    auto& replica = replicaFactory.getCell();
+
+    ASSERT_THAT(replica.getCompartments().size(), Eq(1u));
+    ASSERT_THAT(getAllDiscs(replica).size(), Eq(2u));
+    EXPECT_THAT(&replicaFactory.getSimulationContext().discTypeRegistry, Eq(&getDiscTypeRegistry()));
+
+    replica.update(timeStep);
+    EXPECT_THAT(replica.getDiscs().front().getTypeID(), Eq(getIDFor("D")));
+    EXPECT_THAT(replica.getDiscs().front().getPosition().y, DoubleNear(-200 + timeStep, MaxPositionError));
+    EXPECT_THAT(simulationFactory.getCell().getDiscs().front().getTypeID(), Eq(getIDFor("B")));
+    EXPECT_THAT(simulationFactory.getCell().getDiscs().front().getPosition().y, DoubleNear(-200, MaxPositionError));
+
+    EXPECT_THROW(replicaFactory.validateCommand(command::SetPermeability{"M", "B", MembraneType::Permeability::Inward}),
+                 ExceptionWithLocation);
+
+    replicaConfig.discTypes.pop_back();
+    EXPECT_THROW(replicaFactory.buildReplicaOf(simulationFactory, replicaConfig), InvalidSetupException);
+}
+
+TEST_F(ACell, CountsTheCollisionsOfReplicasUpdatedConcurrentlySeparately)
+{
+    builder.addDisc("A", Position{.x = -20, .y = 0}, Velocity{.x = 10, .y = 0});
+    builder.addDisc("B", Position{.x = 20, .y = 0}, Velocity{.x = -10, .y = 0});
+    builder.addDisc("C", Position{.x = -20, .y = 500}, Velocity{.x = 10, .y = 0});
+    builder.addDisc("D", Position{.x = 20, .y = 500}, Velocity{.x = -10, .y = 0});
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+    auto& cell = simulationFactory.getCell();
+
+    SimulationFactory replicaFactory;
+    replicaFactory.buildReplicaOf(simulationFactory, builder.getSimulationConfig());
+    auto& replica = replicaFactory.getCell();
+
+    // A and B only collide in the cell, C and D only in the replica
+    cell.removeDiscsInCircle(Vector2d{0, 500}, 50);
+    replica.removeDiscsInCircle(Vector2d{0, 0}, 50);
+
+    auto updateRepeatedly = [this](Cell& cellToUpdate)
+    {
+        for (int i = 0; i < 1000; ++i)
+            cellToUpdate.update(timeStep);
+    };
+    {
+        std::jthread cellThread(updateRepeatedly, std::ref(cell));
+        std::jthread replicaThread(updateRepeatedly, std::ref(replica));
+    }
+
+    const auto cellCollisionCounts = cell.getAndResetCollisionCounts();
+    const auto replicaCollisionCounts = replica.getAndResetCollisionCounts();
+
+    EXPECT_THAT(cellCollisionCounts.at(getIDFor("A")), Gt(0));
+    EXPECT_THAT(cellCollisionCounts.at(getIDFor("B")), Eq(cellCollisionCounts.at(getIDFor("A"))));
+    EXPECT_THAT(cellCollisionCounts.contains(getIDFor("C")) || cellCollisionCounts.contains(getIDFor("D")), Eq(false));
+
+    EXPECT_THAT(replicaCollisionCounts.at(getIDFor("C")), Gt(0));
+    EXPECT_THAT(replicaCollisionCounts.at(getIDFor("D")), Eq(replicaCollisionCounts.at(getIDFor("C"))));
+    EXPECT_THAT(replicaCollisionCounts.contains(getIDFor("A")) || replicaCollisionCounts.contains(getIDFor("B")),
+                Eq(false));
 }
\ No newline at end of file
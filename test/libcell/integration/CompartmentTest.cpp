@@ -7,6 +7,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 using namespace testing;
 using namespace cell;
 
@@ -164,6 +166,112 @@ TEST_F(ACompartment, CanHaveADiscDistribution)
     ASSERT_TRUE(notContainedInOthers(largeCompartment, {&smallCompartment}, context));
 }
 
+TEST_F(ACompartment, UsesEveryFreeGridPointWhenSiblingsArePopulatedInParallel)
+{
+    builder.setWorkerThreads(4);
+    builder.setDiscCount("", 1000000);
+    builder.setDiscCount("Large", 1000000);
+    builder.setDiscCount("Small", 1000000);
+    builder.setDistribution("", {{"A", 1}});
+    builder.setDistribution("Large", {{"A", 1}});
+    builder.setDistribution("Small", {{"B", 1}});
+    for (int i = 0; i < 4; ++i)
+        builder.addMembrane("Small", Position{.x = -600.0 + 120 * i, .y = -300});
+
+    auto& cell = getCell();
+    const auto context = simulationFactory.getSimulationContext();
+    const auto cellRadius = getRadius(cell);
+
+    // Brute force over the bounding square, as the grid used to be filtered
+    const double spacing = 2 * 1 + 1;
+    const int n = static_cast<int>(2 * cellRadius / spacing);
+    std::size_t expectedCount = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            const Vector2d point{-cellRadius + spacing * (i + 1), -cellRadius + spacing * (j + 1)};
+            bool valid = mathutils::circleIsFullyContainedByCircle(point, 1, {0, 0}, cellRadius);
+            for (const auto& compartment : cell.getCompartments())
+                valid = valid && !mathutils::circlesOverlap(point, 1, compartment->getMembrane().getPosition(),
+                                                            getRadius(*compartment));
+            expectedCount += valid;
+        }
+    }
+
+    EXPECT_EQ(cell.getDiscs().size(), expectedCount);
+
+    std::vector<const Compartment*> children;
+    for (const auto& compartment : cell.getCompartments())
+    {
+        children.push_back(compartment.get());
+        EXPECT_FALSE(compartment->getDiscs().empty());
+    }
+
+    ASSERT_TRUE(notContainedInOthers(cell, children, context));
+    for (const auto* child : children)
+        ASSERT_TRUE(notContainedInOthers(*child, {}, context));
+}
+
+TEST_F(ACompartment, FitsMoreMixedDiscsWithPoissonDiscSampling)
+{
+    builder.addDiscType("C", Radius{5}, Mass{1});
+    builder.setDiscCount("Large", 10000);
+    builder.setDistribution("Large", {{"A", 0.9}, {"C", 0.1}});
+
+    const auto countDiscs = [&](config::PopulationMode populationMode)
+    {
+        builder.setPopulationMode(populationMode);
+        builder.setPopulationRelaxationSweeps(3);
+        const auto& large = *getCell().getCompartments().front();
+        const auto& small = getSingleChildCompartment(large);
+        const auto& discs = large.getDiscs();
+        const auto radius = [&](const Disc& disc)
+        { return getDiscTypeRegistry().getByID(disc.getTypeID()).getRadius(); };
+
+        for (std::size_t i = 0; i < discs.size(); ++i)
+        {
+            EXPECT_TRUE(mathutils::circleIsFullyContainedByCircle(discs[i].getPosition(), radius(discs[i]),
+                                                                  large.getMembrane().getPosition(), getRadius(large)));
+            EXPECT_FALSE(mathutils::circlesOverlap(discs[i].getPosition(), radius(discs[i]),
+                                                   small.getMembrane().getPosition(), getRadius(small)));
+
+            for (std::size_t j = i + 1; j < discs.size(); ++j)
+            {
+                if (mathutils::circlesOverlap(discs[i].getPosition(), radius(discs[i]), discs[j].getPosition(),
+                                              radius(discs[j])))
+                {
+                    ADD_FAILURE() << "Discs " << i << " and " << j << " overlap";
+                    return discs.size();
+                }
+            }
+        }
+
+        return discs.size();
+    };
+
+    const auto gridCount = countDiscs(config::PopulationMode::Grid);
+    const auto poissonDiscCount = countDiscs(config::PopulationMode::PoissonDisc);
+
+    EXPECT_GT(poissonDiscCount, 3 * gridCount);
+}
+
+TEST_F(ACompartment, KeepsPlacingSmallDiscsAfterLargeOnesNoLongerFit)
+{
+    // Only a few of the large discs fit, but there's room for all small discs between them
+    builder.addDiscType("C", Radius{45}, Mass{1});
+    builder.setDiscCount("Large", 400);
+    builder.setDistribution("Large", {{"A", 0.5}, {"C", 0.5}});
+    builder.setPopulationMode(config::PopulationMode::PoissonDisc);
+
+    const auto& large = *getCell().getCompartments().front();
+    const auto smallDiscCount = std::ranges::count_if(
+        large.getDiscs(), [&](const Disc& disc) { return disc.getTypeID() == getDiscTypeRegistry().getIDFor("A"); });
+
+    EXPECT_LT(large.getDiscs().size(), 400u);
+    EXPECT_EQ(smallDiscCount, 200);
+}
+
 TEST_F(ACompartment, CantOverlapWithAnotherCompartment)
 {
     builder.addMembraneType("M", Radius{100}, {});
@@ -173,6 +281,26 @@ TEST_F(ACompartment, CantOverlapWithAnotherCompartment)
     ASSERT_ANY_THROW(getCell());
 }
 
+TEST_F(ACompartment, IsValidatedWithoutBeingPopulated)
+{
+    builder.setDiscCount("", 1000000);
+    builder.setDistribution("", {{"A", 0.5}, {"B", 0.4}});
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(builder.getSimulationConfig()), InvalidSetupException);
+
+    builder.setDistribution("", {{"A", 0.5}, {"B", 0.5}});
+    builder.addMembrane("Small", Position{.x = 0, .y = 0});
+    builder.addMembrane("Small", Position{.x = 30, .y = 0});
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(builder.getSimulationConfig()), InvalidSetupException);
+
+    builder.addMembrane("Small", Position{.x = 5000, .y = 0});
+    auto simulationConfig = builder.getSimulationConfig();
+    simulationConfig.membranes.erase(simulationConfig.membranes.end() - 3, simulationConfig.membranes.end() - 1);
+    EXPECT_THROW(SimulationFactory::validateSimulationConfig(simulationConfig), InvalidSetupException);
+
+    simulationConfig.membranes.pop_back();
+    SimulationFactory::validateSimulationConfig(simulationConfig);
+}
+
 TEST_F(ACompartment, MustBeLargerThanTheLargestDiscType)
 {
     builder.addDiscType("Large", Radius{50}, Mass{1});
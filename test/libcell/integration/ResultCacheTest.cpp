@@ -0,0 +1,134 @@
+#include "cell/ResultCache.hpp"
+#include "cell/Cell.hpp"
+#include "cell/ExceptionWithLocation.hpp"
+#include "cell/SimulationConfigBuilder.hpp"
+#include "cell/SimulationFactory.hpp"
+#include "cell/SimulationRunner.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+
+class AResultCache : public Test
+{
+protected:
+    const fs::path cacheDirectory = "resultCache";
+    SimulationConfigBuilder builder;
+    ResultCache resultCache{cacheDirectory};
+    ResultCache::Key key;
+
+    void SetUp() override
+    {
+        builder.addDiscType("A", Radius{5}, Mass{1});
+        builder.setTimeStep(1ms);
+        builder.useDistribution(false);
+        builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 1, .y = 0});
+
+        key = ResultCache::Key{.simulationConfig = builder.getSimulationConfig(), .seed = 1, .storageInterval = 1ms};
+
+        std::ofstream typeCounts("typeCounts.csv");
+        typeCounts << "ElapsedTime[s],A\n0,1\n0.001,1\n0.002,1\n0.003,1\n";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(cacheDirectory);
+        fs::remove("typeCounts.csv");
+        fs::remove("cachedTypeCounts.csv");
+    }
+
+    std::vector<std::string> readLines(const fs::path& path)
+    {
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+
+        return lines;
+    }
+};
+
+TEST_F(AResultCache, FindsEntriesOnlyForTheSameKey)
+{
+    EXPECT_THAT(resultCache.find(key).has_value(), Eq(false));
+
+    resultCache.store(key, "typeCounts.csv", 3ms, key.simulationConfig);
+
+    auto otherKey = key;
+    otherKey.seed = 2;
+    EXPECT_THAT(resultCache.find(otherKey).has_value(), Eq(false));
+
+    const auto entry = resultCache.find(key);
+    ASSERT_THAT(entry.has_value(), Eq(true));
+    EXPECT_THAT(entry->duration, Eq(3ms));
+    EXPECT_THAT(entry->checkpoint, Eq(key.simulationConfig));
+}
+
+TEST_F(AResultCache, IgnoresSettingsThatDontChangeTheResult)
+{
+    auto otherKey = key;
+    otherKey.simulationConfig.simulationTimeScale = 10;
+    otherKey.simulationConfig.populationMode = config::PopulationMode::PoissonDisc;
+
+    EXPECT_THAT(ResultCache::hash(otherKey), Eq(ResultCache::hash(key)));
+
+    otherKey.simulationConfig.discs.front().vx = 2;
+    EXPECT_THAT(ResultCache::hash(otherKey), Ne(ResultCache::hash(key)));
+}
+
+TEST_F(AResultCache, WritesTheTypeCountsOfShorterDurations)
+{
+    resultCache.store(key, "typeCounts.csv", 3ms, key.simulationConfig);
+
+    resultCache.writeTypeCounts(key, *resultCache.find(key), "cachedTypeCounts.csv", 2ms);
+
+    EXPECT_THAT(readLines("cachedTypeCounts.csv"), ElementsAre("ElapsedTime[s],A", "0,1", "0.001,1", "0.002,1"));
+}
+
+TEST_F(AResultCache, RejectsDurationsThatArentAMultipleOfTheStorageInterval)
+{
+    key.storageInterval = 2ms;
+    EXPECT_THROW(resultCache.store(key, "typeCounts.csv", 3ms, key.simulationConfig), ExceptionWithLocation);
+    EXPECT_THAT(resultCache.find(key).has_value(), Eq(false));
+}
+
+TEST_F(AResultCache, StoresCheckpointsThatRebuildTheCell)
+{
+    SimulationRunner simulationRunner;
+    simulationRunner.useConfig(key.simulationConfig);
+    simulationRunner.setSimulationDuration(10ms);
+    simulationRunner.runSimulation();
+    simulationRunner.waitForSimulationToFinish();
+
+    const auto checkpoint = simulationRunner.createCheckpoint();
+    ASSERT_THAT(checkpoint.discs.size(), Eq(1u));
+    EXPECT_THAT(checkpoint.discs.front().x, Gt(0));
+
+    resultCache.store(key, "typeCounts.csv", 10ms, checkpoint);
+    EXPECT_THAT(resultCache.find(key)->checkpoint, Eq(checkpoint));
+}
+
+TEST_F(AResultCache, StoresCheckpointsThatKeepDiscsCrossingAMembraneInTheirCompartment)
+{
+    builder.addMembraneType("M", Radius{50}, {});
+    builder.addMembrane("M", Position{.x = 0, .y = 0});
+    auto simulationConfig = builder.getSimulationConfig();
+    simulationConfig.discs = {config::Disc{.discTypeName = "A", .x = 48, .compartment = 1}};
+
+    SimulationFactory simulationFactory;
+    simulationFactory.buildSimulationFromConfig(simulationConfig);
+    const auto checkpoint = simulationFactory.createCheckpoint();
+    ASSERT_THAT(checkpoint.discs.size(), Eq(1u));
+    EXPECT_THAT(checkpoint.discs.front().compartment, Eq(1));
+
+    SimulationFactory rebuiltSimulationFactory;
+    rebuiltSimulationFactory.buildSimulationFromConfig(checkpoint);
+    const auto& cell = rebuiltSimulationFactory.getCell();
+    EXPECT_THAT(cell.getDiscs().size(), Eq(0u));
+    EXPECT_THAT(cell.getCompartments().front()->getDiscs().size(), Eq(1u));
+}
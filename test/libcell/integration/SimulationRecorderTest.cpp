@@ -0,0 +1,225 @@
+#include "cell/SimulationRecorder.hpp"
+#include "cell/Cell.hpp"
+#include "cell/DataPoint.hpp"
+#include "cell/DataPointSink.hpp"
+#include "cell/DownsamplingDataPointSink.hpp"
+#include "cell/SimulationConfigBuilder.hpp"
+#include "cell/SimulationFactory.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using namespace testing;
+using namespace cell;
+
+class ASimulationRecorder : public Test
+{
+protected:
+    SimulationConfigBuilder builder;
+    SimulationFactory simulationFactory;
+    std::unique_ptr<SimulationRecorder> simulationRecorder;
+
+    void SetUp() override
+    {
+        builder.addDiscType("A", Radius{5}, Mass{1});
+        builder.addDiscType("B", Radius{5}, Mass{1});
+        builder.useDistribution(false);
+        builder.addDisc("A", Position{.x = 50, .y = 50}, Velocity{.x = 1, .y = 1});
+        builder.addDisc("B", Position{.x = -50, .y = -50}, Velocity{.x = 1, .y = 1});
+
+        simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+        simulationRecorder = std::make_unique<SimulationRecorder>(getDiscTypeRegistry(), 600);
+        simulationRecorder->setStorageInterval(ch::milliseconds{1});
+    }
+
+    const DiscTypeRegistry& getDiscTypeRegistry()
+    {
+        return simulationFactory.getSimulationContext().discTypeRegistry;
+    }
+
+    void record(int updates)
+    {
+        auto& cell = simulationFactory.getCell();
+        simulationRecorder->processInitialSimulationData(cell);
+
+        for (int i = 0; i < updates; ++i)
+        {
+            cell.update(1e-3);
+            simulationRecorder->processSimulationData(cell, ch::milliseconds{1});
+        }
+
+        simulationRecorder->storeRemainingData();
+    }
+};
+
+TEST_F(ASimulationRecorder, KeepsAllDataPointsInMemoryByDefault)
+{
+    record(10);
+
+    ASSERT_THAT(simulationRecorder->getDataPoints().size(), Eq(11u));
+}
+
+TEST_F(ASimulationRecorder, KeepsOnlyTheLastDataPointsWithARingBuffer)
+{
+    simulationRecorder->setDataPointSink(std::make_unique<RingBufferDataPointSink>(4));
+
+    record(10);
+
+    const auto& dataPoints = simulationRecorder->getDataPoints();
+    ASSERT_THAT(dataPoints.size(), Eq(4u));
+    EXPECT_THAT(dataPoints.front().getData().elapsedTime, Eq(ch::milliseconds{1}));
+}
+
+TEST_F(ASimulationRecorder, StreamsTypeCountsToCsv)
+{
+    simulationRecorder->setDataPointSink(std::make_unique<TypeCountsCsvSink>("typeCounts.csv", getDiscTypeRegistry()));
+
+    record(10);
+
+    EXPECT_THROW(simulationRecorder->getDataPoints(), ExceptionWithLocation);
+
+    std::ifstream in("typeCounts.csv");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+
+    ASSERT_THAT(lines.size(), Eq(12u));
+    EXPECT_THAT(lines.front(), Eq("ElapsedTime[s],A,B"));
+    EXPECT_THAT(lines[1], Eq("0,1,1"));
+    EXPECT_THAT(lines.back(), Eq("0.01,1,1"));
+}
+
+TEST_F(ASimulationRecorder, AppendsTypeCountsToCsvWithContinuedTimes)
+{
+    simulationRecorder->setDataPointSink(std::make_unique<TypeCountsCsvSink>("typeCounts.csv", getDiscTypeRegistry()));
+    record(2);
+    simulationRecorder->setDataPointSink(
+        std::make_unique<TypeCountsCsvSink>("typeCounts.csv", getDiscTypeRegistry(), ch::milliseconds{2}));
+
+    auto& cell = simulationFactory.getCell();
+    cell.update(1e-3);
+    simulationRecorder->processSimulationData(cell, ch::milliseconds{1});
+    simulationRecorder->storeRemainingData();
+
+    std::ifstream in("typeCounts.csv");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+
+    EXPECT_THAT(lines, ElementsAre("ElapsedTime[s],A,B", "0,1,1", "0.001,1,1", "0.002,1,1", "0.003,1,1"));
+}
+
+TEST_F(ASimulationRecorder, AggregatesDataPointsIntoCoarserLevels)
+{
+    auto sink = std::make_unique<DownsamplingDataPointSink>(ch::milliseconds{1}, 3);
+    const auto& dataPointHistory = *sink;
+    simulationRecorder->setDataPointSink(std::move(sink));
+
+    record(100);
+
+    std::vector<std::size_t> levelSizes;
+    for (std::size_t level = 0; level < dataPointHistory.getLevelCount(); ++level)
+        dataPointHistory.readLevel(level, [&](const auto& dataPoints) { levelSizes.push_back(dataPoints.size()); });
+
+    ASSERT_THAT(levelSizes, ElementsAre(101u, 11u, 2u));
+    EXPECT_THAT(dataPointHistory.getCoarsestLevelFor(ch::milliseconds{50}), Eq(1u));
+    EXPECT_THAT(dataPointHistory.getCoarsestLevelFor(ch::milliseconds{200}), Eq(2u));
+
+    dataPointHistory.readLevel(2,
+                               [](const auto& dataPoints)
+                               {
+                                   const auto& data = dataPoints.back().getData();
+                                   EXPECT_THAT(data.elapsedTime, Eq(ch::milliseconds{100}));
+                                   EXPECT_THAT(data.discTypeCounts.at(0), DoubleEq(1.0));
+                               });
+}
+
+TEST_F(ASimulationRecorder, ReadsOnlyTheNewestDataPointsOfALevel)
+{
+    auto sink = std::make_unique<DownsamplingDataPointSink>(ch::milliseconds{1}, 3);
+    const auto& dataPointHistory = *sink;
+    simulationRecorder->setDataPointSink(std::move(sink));
+
+    record(100);
+
+    dataPointHistory.readLevel(
+        0,
+        [](const auto& dataPoints)
+        {
+            ASSERT_THAT(dataPoints.size(), Eq(5u));
+            EXPECT_THAT(dataPoints.front().getData().elapsedTime, Eq(ch::milliseconds{1}));
+        },
+        5);
+
+    // Levels with fewer data points are read completely, including the initial data point
+    dataPointHistory.readLevel(
+        2,
+        [](const auto& dataPoints)
+        {
+            ASSERT_THAT(dataPoints.size(), Eq(2u));
+            EXPECT_THAT(dataPoints.front().getData().elapsedTime, Eq(ch::nanoseconds{0}));
+        },
+        5);
+}
+
+TEST_F(ASimulationRecorder, MergesOldDataPointsOfFullLevels)
+{
+    auto sink = std::make_unique<DownsamplingDataPointSink>(ch::milliseconds{1}, 1, 10, 20);
+    const auto& dataPointHistory = *sink;
+    simulationRecorder->setDataPointSink(std::move(sink));
+
+    record(100);
+
+    dataPointHistory.readLevel(0,
+                               [](const auto& dataPoints)
+                               {
+                                   EXPECT_THAT(dataPoints.size(), Lt(20u));
+                                   EXPECT_THAT(dataPoints.front().getData().elapsedTime, Eq(ch::nanoseconds{0}));
+                                   EXPECT_THAT(dataPoints.back().getData().elapsedTime, Eq(ch::milliseconds{1}));
+
+                                   ch::nanoseconds totalTime{0};
+                                   for (const auto& dataPoint : dataPoints)
+                                       totalTime += dataPoint.getData().elapsedTime;
+                                   EXPECT_THAT(totalTime, Eq(ch::milliseconds{100}));
+                               });
+}
+
+TEST_F(ASimulationRecorder, CollectsTheSameStatisticsAsAPassOverAllDiscs)
+{
+    builder.setMostProbableSpeed(100);
+    for (int i = 0; i < 40; ++i)
+    {
+        const double v = 20.0 * (i - 20);
+        builder.addDisc(i % 2 ? "A" : "B", Position{.x = -400.0 + 20 * i, .y = 0}, Velocity{.x = v, .y = -0.5 * v});
+    }
+    simulationFactory.buildSimulationFromConfig(builder.getSimulationConfig());
+
+    auto& cell = simulationFactory.getCell();
+    cell.update(1e-3);
+
+    const auto discTypeIDs = getDiscTypeRegistry().getIDs();
+    DataPoint dataPoint;
+    dataPoint.initializeHistograms(discTypeIDs, 100);
+    ASSERT_THAT(dataPoint.addSimulationData(cell, ch::milliseconds{1}), Eq(true));
+
+    DataPoint expected;
+    expected.initializeHistograms(discTypeIDs, 100);
+    auto expectedData = expected.getData();
+    double kineticEnergy = 0;
+    for (const auto& disc : cell.getDiscs())
+    {
+        kineticEnergy += disc.getKineticEnergy(1);
+        expectedData.vxHistogram.fill(disc.getTypeID(), disc.getVelocity().x);
+        expectedData.vyHistogram.fill(disc.getTypeID(), disc.getVelocity().y);
+        expectedData.vHistogram.fill(disc.getTypeID(), mathutils::abs(disc.getVelocity()));
+    }
+
+    const auto& data = dataPoint.getData();
+    EXPECT_THAT(data.discTypeCounts.at(0) + data.discTypeCounts.at(1), DoubleEq(42.0));
+    EXPECT_THAT(data.totalKineticEnergies.at(0) + data.totalKineticEnergies.at(1), DoubleEq(kineticEnergy));
+    EXPECT_THAT(data.vxHistogram == expectedData.vxHistogram, Eq(true));
+    EXPECT_THAT(data.vyHistogram == expectedData.vyHistogram, Eq(true));
+    EXPECT_THAT(data.vHistogram == expectedData.vHistogram, Eq(true));
+}
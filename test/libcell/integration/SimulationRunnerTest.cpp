@@ -0,0 +1,121 @@
+#include "cell/SimulationRunner.hpp"
+#include "cell/Cell.hpp"
+#include "cell/SimulationConfigBuilder.hpp"
+#include "cell/SimulationContext.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+
+class ASimulationRunner : public Test
+{
+protected:
+    SimulationConfigBuilder builder;
+    std::atomic<int> updates = 0; // Declared first, the runner's thread might still use it while being destroyed
+    SimulationRunner simulationRunner;
+
+    void SetUp() override
+    {
+        builder.addDiscType("A", Radius{5}, Mass{1});
+        builder.useDistribution(false);
+        builder.addDisc("A", Position{.x = 0, .y = 0}, Velocity{.x = 1, .y = 0});
+
+        simulationRunner.useConfig(builder.getSimulationConfig());
+    }
+
+    bool waitForUpdates(int count)
+    {
+        for (int i = 0; i < 1000 && updates < count; ++i)
+            std::this_thread::sleep_for(1ms);
+
+        return updates >= count;
+    }
+};
+
+TEST_F(ASimulationRunner, RunsSingleStepsWhilePaused)
+{
+    simulationRunner.setPostUpdateCallback(
+        [&](Cell&, const ch::nanoseconds&)
+        {
+            // Paused before the update is counted, so that the steps below can't be requested before the pause
+            if (updates == 0)
+                simulationRunner.pauseSimulation();
+            ++updates;
+        });
+    simulationRunner.runSimulation();
+    ASSERT_THAT(waitForUpdates(1), Eq(true));
+
+    simulationRunner.stepSimulation();
+    simulationRunner.stepSimulation();
+    ASSERT_THAT(waitForUpdates(3), Eq(true));
+    std::this_thread::sleep_for(20ms);
+    EXPECT_THAT(updates.load(), Eq(3));
+    EXPECT_THAT(simulationRunner.simulationIsPaused(), Eq(true));
+
+    simulationRunner.resumeSimulation();
+    EXPECT_THAT(waitForUpdates(10), Eq(true));
+
+    simulationRunner.stopSimulation();
+    simulationRunner.waitForSimulationToFinish();
+}
+
+TEST_F(ASimulationRunner, WaitsOncePerBatchWhenPacing)
+{
+    builder.setTimeStep(1ms);
+    builder.setTimeScale(1);
+    simulationRunner.useConfig(builder.getSimulationConfig());
+    simulationRunner.setUseScaleFromConfig(true);
+    simulationRunner.setPacingInterval(20ms);
+
+    std::optional<SimulationRunner::PerformanceData> performanceData;
+    simulationRunner.setPerformanceDataCallback([&](const SimulationRunner::PerformanceData& data)
+                                                { performanceData = data; });
+    simulationRunner.setPostUpdateCallback([&](Cell&, const ch::nanoseconds&) { ++updates; });
+
+    simulationRunner.runSimulation();
+    ASSERT_THAT(waitForUpdates(200), Eq(true));
+    simulationRunner.stopSimulation();
+    simulationRunner.waitForSimulationToFinish();
+
+    ASSERT_THAT(performanceData.has_value(), Eq(true));
+    EXPECT_THAT(performanceData->updatesPerBatch, Ge(10));
+    EXPECT_THAT(performanceData->pacingError, Ge(0ns));
+}
+
+TEST_F(ASimulationRunner, GivesTheSameResultsForTheSameSeed)
+{
+    builder.addDiscType("B", Radius{5}, Mass{1});
+    builder.addDiscType("C", Radius{5}, Mass{1});
+    builder.addReaction("A", "", "B", "", Probability{0.5});
+    builder.addReaction("A", "", "C", "", Probability{0.5});
+    for (int i = 1; i <= 100; ++i)
+        builder.addDisc("A", Position{.x = 20.0 * (i % 10), .y = 20.0 * (i / 10)}, Velocity{.x = 0, .y = 0});
+    builder.setTimeStep(10ms);
+
+    const auto countDiscsOfType = [&](const std::string& name)
+    {
+        simulationRunner.useConfig(builder.getSimulationConfig());
+        simulationRunner.setRandomSeed(42);
+        simulationRunner.setSimulationDuration(1s);
+        simulationRunner.runSimulation();
+        simulationRunner.waitForSimulationToFinish();
+
+        const auto discTypeID = simulationRunner.getSimulationContext().discTypeRegistry.getIDFor(name);
+        const auto& discs = simulationRunner.getCell().getDiscs();
+        return std::count_if(discs.begin(), discs.end(),
+                             [&](const Disc& disc) { return disc.getTypeID() == discTypeID; });
+    };
+
+    const auto firstCount = countDiscsOfType("B");
+    for (int i = 0; i < 5; ++i)
+        EXPECT_THAT(countDiscsOfType("B"), Eq(firstCount));
+    EXPECT_THAT(firstCount, AllOf(Gt(0), Lt(101)));
+}
@@ -0,0 +1,115 @@
+#include "cell/CollisionDetector.hpp"
+#include "cell/DiscType.hpp"
+#include "cell/MembraneType.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+
+using namespace testing;
+using namespace cell;
+
+class ACollisionDetector : public Test
+{
+protected:
+    DiscTypeRegistry discTypeRegistry;
+    MembraneTypeRegistry membraneTypeRegistry;
+    std::vector<Disc> discs;
+    std::vector<Membrane> membranes;
+    std::vector<Disc*> intrudingDiscs;
+    Membrane containingMembrane{0};
+
+    void SetUp() override
+    {
+        std::vector<DiscType> discTypes;
+        discTypes.emplace_back("A", Radius{5}, Mass{1});
+        discTypes.emplace_back("B", Radius{10}, Mass{1});
+        discTypeRegistry.setValues(std::move(discTypes));
+
+        std::vector<MembraneType> membraneTypes;
+        membraneTypes.emplace_back("M", 1000, MembraneType::PermeabilityMap{});
+        membraneTypeRegistry.setValues(std::move(membraneTypes));
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> position(-300, 300);
+        for (int i = 0; i < 500; ++i)
+        {
+            discs.emplace_back(static_cast<DiscTypeID>(i % 2));
+            discs.back().setPosition(Vector2d{position(generator), position(generator)});
+        }
+    }
+
+    CollisionDetector createDetector(double neighborListSkin, bool useContactCache = false)
+    {
+        CollisionDetector collisionDetector(discTypeRegistry, membraneTypeRegistry);
+        collisionDetector.setParams(CollisionDetector::Params{.discs = &discs,
+                                                              .membranes = &membranes,
+                                                              .intrudingDiscs = &intrudingDiscs,
+                                                              .containingMembrane = &containingMembrane,
+                                                              .neighborListSkin = neighborListSkin,
+                                                              .useContactCache = useContactCache});
+
+        return collisionDetector;
+    }
+
+    std::set<std::pair<const Disc*, const Disc*>> detect(CollisionDetector& collisionDetector)
+    {
+        collisionDetector.buildDiscIndex();
+        collisionDetector.addIntrudingDiscsToIndex();
+
+        std::set<std::pair<const Disc*, const Disc*>> pairs;
+        for (const auto& collision : collisionDetector.detectDiscDiscCollisions())
+            pairs.insert(std::minmax<const Disc*>(collision.disc, collision.otherDisc));
+
+        return pairs;
+    }
+};
+
+TEST_F(ACollisionDetector, FindsTheSameCollisionsWithANeighborList)
+{
+    auto sweepAndPrune = createDetector(0);
+    auto neighborList = createDetector(10);
+
+    Disc intruder(0);
+    intruder.setPosition(discs.front().getPosition() + Vector2d{3, 0});
+    intrudingDiscs.push_back(&intruder);
+
+    const auto expected = detect(sweepAndPrune);
+    ASSERT_THAT(expected.empty(), Eq(false));
+    ASSERT_THAT(detect(neighborList), Eq(expected));
+
+    // Moving every disc by less than half the skin keeps the neighbor list valid
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> offset(-3, 3);
+    for (auto& disc : discs)
+        disc.move(Vector2d{offset(generator), offset(generator)});
+    neighborList.addDisplacement(std::sqrt(18.0));
+
+    EXPECT_THAT(detect(neighborList), Eq(detect(sweepAndPrune)));
+}
+
+TEST_F(ACollisionDetector, DoesntReportAResolvedContactAgainWhileItSeparates)
+{
+    discs.clear();
+    discs.emplace_back(0);
+    discs.emplace_back(0);
+    discs[0].setPosition(Vector2d{0, 0});
+    discs[1].setPosition(Vector2d{8, 0});
+    discs[0].setVelocity(Vector2d{1, 0});
+
+    auto collisionDetector = createDetector(0, true);
+    ASSERT_THAT(detect(collisionDetector).size(), Eq(1u));
+
+    // Resolved, but still overlapping
+    discs[0].setVelocity(Vector2d{-1, 0});
+    EXPECT_THAT(detect(collisionDetector).empty(), Eq(true));
+
+    // Another collision turned it around
+    discs[0].setVelocity(Vector2d{1, 0});
+    EXPECT_THAT(detect(collisionDetector).size(), Eq(1u));
+
+    auto collisionCounts = collisionDetector.getAndResetCollisionCounts();
+    EXPECT_THAT(collisionCounts[0], Eq(4));
+}
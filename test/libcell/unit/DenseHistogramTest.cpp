@@ -0,0 +1,70 @@
+#include "cell/DenseHistogram.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace testing;
+using namespace cell;
+
+class ADenseHistogram : public Test
+{
+protected:
+    std::vector<DiscTypeID> discTypeIDs{0, 1, 2};
+    DenseHistogram histogram{discTypeIDs, 20, -3, 3, "v_x"};
+};
+
+TEST_F(ADenseHistogram, SortsValuesIntoTheSameBinsAsBoost)
+{
+    auto boostHistogram = bh::make_histogram(bh::axis::category<DiscTypeID>(discTypeIDs, "Disc type"),
+                                             bh::axis::regular<>(20, -3, 3, "v_x"));
+
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0, 1.5);
+    std::vector<DiscTypeID> types;
+    std::vector<double> values;
+    for (int i = 0; i < 5000; ++i)
+    {
+        types.push_back(static_cast<DiscTypeID>(i % 3));
+        values.push_back(distribution(generator));
+        boostHistogram(types.back(), values.back());
+    }
+
+    // Edge cases: bin edges, range limits, infinities
+    for (double value : {-3.0, 3.0, 0.0, -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity()})
+    {
+        types.push_back(1);
+        values.push_back(value);
+        boostHistogram(DiscTypeID{1}, value);
+    }
+
+    histogram.fill(types, values);
+
+    EXPECT_THAT(histogram.toHistogram() == boostHistogram, Eq(true));
+}
+
+TEST_F(ADenseHistogram, FillsTheSameWayOneAtATimeAndInBatches)
+{
+    DenseHistogram singleFills = histogram;
+    std::vector<DiscTypeID> types;
+    std::vector<double> values;
+    for (int i = 0; i < 1000; ++i)
+    {
+        types.push_back(static_cast<DiscTypeID>(i % 4)); // Type 3 has no row and is ignored
+        values.push_back(0.01 * (i - 500));
+        singleFills.fill(types.back(), values.back());
+    }
+    singleFills.fill(0, std::nan(""));
+    types.push_back(0);
+    values.push_back(std::nan(""));
+
+    histogram.fill(types, values);
+
+    ASSERT_THAT(histogram, Eq(singleFills));
+    EXPECT_THAT(histogram.at(0, -1), DoubleEq(50));
+    EXPECT_THAT(histogram.at(0, 20), DoubleEq(51));
+}
@@ -0,0 +1,55 @@
+#include "cell/EquilibriumDetector.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace testing;
+using namespace cell;
+using namespace std::chrono_literals;
+
+class AnEquilibriumDetector : public Test
+{
+protected:
+    EquilibriumDetector detector{{0, 1}, EquilibriumDetector::Params{.windowSize = 20}};
+    std::mt19937 generator{42};
+    std::normal_distribution<double> noise{0, 2};
+
+    DataPoint::Data makeData(double countA, double countB)
+    {
+        DataPoint::Data data;
+        data.elapsedTime = 10ms;
+        data.discTypeCounts = {{0, countA + noise(generator)}, {1, countB + noise(generator)}};
+        data.totalKineticEnergies = {{0, 5 * countA}, {1, 5 * countB}};
+
+        return data;
+    }
+};
+
+TEST_F(AnEquilibriumDetector, DoesntDetectAnEquilibriumWhileCountsDrift)
+{
+    for (int i = 0; i < 200; ++i)
+        EXPECT_THAT(detector.add(makeData(1000 - 2 * i, 2 * i)), Eq(false));
+
+    EXPECT_THAT(detector.isInEquilibrium(), Eq(false));
+}
+
+TEST_F(AnEquilibriumDetector, DetectsTheEquilibriumOnceCountsFlattenOut)
+{
+    int detections = 0;
+    int detectedAt = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        const auto converted = std::min(i, 100);
+        if (detector.add(makeData(1000 - 5 * converted, 5 * converted)))
+        {
+            ++detections;
+            detectedAt = i;
+        }
+    }
+
+    ASSERT_THAT(detections, Eq(1));
+    EXPECT_THAT(detectedAt, AllOf(Ge(100), Le(160)));
+    EXPECT_THAT(detector.getEquilibriumTime(), Eq((detectedAt + 1) * 10ms));
+}
@@ -0,0 +1,39 @@
+#include "cell/QualityOfServiceController.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace cell;
+
+class AQualityOfServiceController : public Test
+{
+protected:
+    QualityOfServiceController controller{config::QualityOfService{
+        .enabled = true, .maxFrameIntervalFactor = 2, .maxRecordingStride = 1, .maxTimeStepFactor = 4}};
+};
+
+TEST_F(AQualityOfServiceController, DoublesOneLeverPerLevelUntilAllReachedTheirLimits)
+{
+    ASSERT_THAT(controller.getMaxLevel(), Eq(3));
+
+    EXPECT_THAT(controller.update(1, 0.5, 1), Eq(true));
+    EXPECT_THAT(controller.getFidelityLevel(), Eq(QualityOfServiceController::FidelityLevel{
+                                                   .level = 1, .frameIntervalFactor = 2, .timeStepFactor = 1}));
+
+    controller.update(1, 0.5, 1);
+    controller.update(1, 0.5, 1);
+    EXPECT_THAT(controller.update(1, 0.5, 1), Eq(false));
+    EXPECT_THAT(controller.getFidelityLevel(), Eq(QualityOfServiceController::FidelityLevel{
+                                                   .level = 3, .frameIntervalFactor = 2, .timeStepFactor = 4}));
+}
+
+TEST_F(AQualityOfServiceController, OnlyRaisesTheFidelityWithEnoughSpareTime)
+{
+    controller.update(1, 0.5, 1);
+    controller.update(1, 0.5, 1);
+
+    EXPECT_THAT(controller.update(1, 1, 0.6), Eq(false));
+    EXPECT_THAT(controller.update(1, 1, 0.2), Eq(true));
+    EXPECT_THAT(controller.getFidelityLevel().level, Eq(1));
+}
@@ -0,0 +1,67 @@
+#include "cell/TripleBuffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace cell;
+
+TEST(ATripleBuffer, HasNothingNewBeforeTheFirstPublish)
+{
+    TripleBuffer<int> buffer;
+
+    ASSERT_FALSE(buffer.update());
+}
+
+TEST(ATripleBuffer, HandsTheLatestPublishedValueToTheConsumer)
+{
+    TripleBuffer<int> buffer;
+
+    buffer.getWriteBuffer() = 1;
+    buffer.publish();
+    buffer.getWriteBuffer() = 2;
+    buffer.publish();
+
+    ASSERT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 2);
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 2);
+}
+
+TEST(ATripleBuffer, NeverHandsOutAValueThatIsBeingWritten)
+{
+    struct Value
+    {
+        int a = 0;
+        int b = 0;
+    };
+
+    TripleBuffer<Value> buffer;
+    constexpr int Iterations = 100000;
+
+    std::thread producer(
+        [&]()
+        {
+            for (int i = 1; i <= Iterations; ++i)
+            {
+                auto& value = buffer.getWriteBuffer();
+                value.a = i;
+                value.b = -i;
+                buffer.publish();
+            }
+        });
+
+    int last = 0;
+    while (last < Iterations)
+    {
+        if (!buffer.update())
+            continue;
+
+        const auto& value = buffer.getReadBuffer();
+        ASSERT_EQ(value.a, -value.b);
+        ASSERT_GT(value.a, last);
+        last = value.a;
+    }
+
+    producer.join();
+}
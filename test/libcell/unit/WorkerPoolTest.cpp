@@ -0,0 +1,37 @@
+#include "cell/WorkerPool.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace testing;
+using namespace cell;
+
+TEST(AWorkerPool, ProcessesEveryIndexExactlyOnce)
+{
+    WorkerPool workerPool(4);
+    std::vector<int> visits(10000, 0);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        workerPool.parallelFor(visits.size(), 100,
+                               [&](std::size_t begin, std::size_t end)
+                               {
+                                   for (std::size_t j = begin; j < end; ++j)
+                                       ++visits[j];
+                               });
+    }
+
+    EXPECT_THAT(visits, Each(Eq(10)));
+}
+
+TEST(AWorkerPool, RunsSmallLoopsOnTheCallingThread)
+{
+    WorkerPool workerPool(4);
+    std::vector<std::thread::id> threadIDs;
+
+    workerPool.parallelFor(10, 100, [&](std::size_t, std::size_t) { threadIDs.push_back(std::this_thread::get_id()); });
+
+    EXPECT_THAT(threadIDs, ElementsAre(std::this_thread::get_id()));
+}